@@ -0,0 +1,44 @@
+#pragma once
+
+#include "position.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Centipawn loss thresholds for move annotations
+constexpr int INACCURACY_LOSS = 50;
+constexpr int MISTAKE_LOSS = 100;
+constexpr int BLUNDER_LOSS = 300;
+constexpr int ANALYSIS_BUDGET_MS = 100;
+
+enum class Annotation {
+    None,
+    Inaccuracy,
+    Mistake,
+    Blunder
+};
+
+struct PlyAnalysis {
+    std::string san;
+    std::string bestSan;   // engine choice in the position before the move
+    int loss = 0;          // centipawns lost by the mover
+    Annotation mark = Annotation::None;
+};
+
+struct GameAnalysis {
+    std::vector<int> evals;          // White's point of view, one per position (plies + 1)
+    std::vector<PlyAnalysis> plies;
+    std::string result;              // PGN result token
+    bool complete = false;
+};
+
+// Searches every position of the game in parallel, budgetMs each, and
+// annotates each move by how much evaluation it gave away. Setting *cancel
+// stops all searches early and returns an incomplete analysis.
+GameAnalysis analyzeGame(const Position &start, const std::vector<Move> &moves,
+                         int threads, int budgetMs = ANALYSIS_BUDGET_MS,
+                         const std::atomic<bool> *cancel = nullptr);
+
+std::string annotationSymbol(Annotation a);
+std::string toPgn(const GameAnalysis &analysis);
+bool exportPgn(const GameAnalysis &analysis, const std::string &path);
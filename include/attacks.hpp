@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+// Precomputed move and attack tables, built at compile time. Squares are
+// indexed y * 8 + x, so y = 0 is Black's back row.
+
+inline constexpr int SQUARES = 64;
+
+struct SquareList {
+    uint8_t count = 0;
+    uint8_t sq[8] = {};
+    constexpr const uint8_t *begin() const { return sq; }
+    constexpr const uint8_t *end() const { return sq + count; }
+};
+
+// Ray directions: the first four are orthogonal, the last four diagonal
+inline constexpr int RAY_DX[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+inline constexpr int RAY_DY[8] = {-1, 0, 1, 0, -1, 1, 1, -1};
+inline constexpr int FIRST_DIAGONAL = 4;
+
+namespace detail {
+
+struct StepTable {
+    SquareList at[SQUARES];
+};
+
+struct RayTable {
+    SquareList at[SQUARES][8];
+};
+
+constexpr bool onBoard(int x, int y) { return x >= 0 && x < 8 && y >= 0 && y < 8; }
+
+template <int N>
+constexpr StepTable makeStepTable(const int (&dx)[N], const int (&dy)[N]) {
+    StepTable t{};
+    for (int sq = 0; sq < SQUARES; ++sq) {
+        for (int i = 0; i < N; ++i) {
+            int x = sq % 8 + dx[i], y = sq / 8 + dy[i];
+            if (onBoard(x, y)) {
+                SquareList &l = t.at[sq];
+                l.sq[l.count++] = static_cast<uint8_t>(y * 8 + x);
+            }
+        }
+    }
+    return t;
+}
+
+constexpr RayTable makeRayTable() {
+    RayTable t{};
+    for (int sq = 0; sq < SQUARES; ++sq) {
+        for (int d = 0; d < 8; ++d) {
+            SquareList &l = t.at[sq][d];
+            for (int x = sq % 8 + RAY_DX[d], y = sq / 8 + RAY_DY[d]; onBoard(x, y); x += RAY_DX[d], y += RAY_DY[d])
+                l.sq[l.count++] = static_cast<uint8_t>(y * 8 + x);
+        }
+    }
+    return t;
+}
+
+inline constexpr int KNIGHT_DX[8] = {1, 2, 2, 1, -1, -2, -2, -1};
+inline constexpr int KNIGHT_DY[8] = {-2, -1, 1, 2, 2, 1, -1, -2};
+inline constexpr int KING_DX[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
+inline constexpr int KING_DY[8] = {-1, -1, -1, 0, 1, 1, 1, 0};
+// Squares a pawn attacks: White moves towards y = 0, Black towards y = 7
+inline constexpr int PAWN_DX[2] = {-1, 1};
+inline constexpr int WHITE_PAWN_DY[2] = {-1, -1};
+inline constexpr int BLACK_PAWN_DY[2] = {1, 1};
+
+} // namespace detail
+
+inline constexpr detail::StepTable KNIGHT_ATTACKS = detail::makeStepTable(detail::KNIGHT_DX, detail::KNIGHT_DY);
+inline constexpr detail::StepTable KING_ATTACKS = detail::makeStepTable(detail::KING_DX, detail::KING_DY);
+// PAWN_ATTACKS[white] lists the squares a pawn of that color attacks
+inline constexpr detail::StepTable PAWN_ATTACKS[2] = {
+    detail::makeStepTable(detail::PAWN_DX, detail::BLACK_PAWN_DY),
+    detail::makeStepTable(detail::PAWN_DX, detail::WHITE_PAWN_DY)};
+inline constexpr detail::RayTable RAYS = detail::makeRayTable();
+
+static_assert(KNIGHT_ATTACKS.at[0].count == 2 && KNIGHT_ATTACKS.at[27].count == 8, "knight table");
+static_assert(KING_ATTACKS.at[63].count == 3, "king table");
+static_assert(RAYS.at[0][1].count == 7 && RAYS.at[0][5].sq[6] == 63, "ray table");
@@ -1,21 +1,32 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include "position.hpp"
+#include "analysis.hpp"
+#include "replay.hpp"
+#include "timeline.hpp"
+#include <atomic>
+#include <future>
 #include <vector>
 #include <set>
 #include <map>
 #include <string>
 
 // Constants for game configuration
-constexpr int WINDOW_WIDTH = 800;
+constexpr int BOARD_PIXELS = 800;
+constexpr int MOVE_PANEL_WIDTH = 220;
+constexpr int WINDOW_WIDTH = BOARD_PIXELS + MOVE_PANEL_WIDTH;
 constexpr int WINDOW_HEIGHT = 950;
 constexpr int MENU_BAR_HEIGHT = 150;
-constexpr int BOARD_SIZE = 8;
-constexpr int SQUARE_SIZE = WINDOW_WIDTH / BOARD_SIZE;
-constexpr int WHITE_PAWN_START_ROW = 6;
-constexpr int BLACK_PAWN_START_ROW = 1;
-constexpr int WHITE_BACK_ROW = 7;
-constexpr int BLACK_BACK_ROW = 0;
+constexpr int SQUARE_SIZE = BOARD_PIXELS / BOARD_SIZE;
+
+// Move list / timeline configuration
+constexpr int MOVE_LIST_HEADER = 40;
+constexpr int MOVE_LIST_LINE_HEIGHT = 22;
+constexpr int SLIDER_MARGIN = 20;
+constexpr int SLIDER_Y = 125;
+constexpr int EVAL_GRAPH_HEIGHT = 160;
+constexpr int EVAL_GRAPH_RANGE = 1000;  // centipawns at the top/bottom edge
 
 enum class GameState {
     Menu,
@@ -23,24 +34,27 @@ enum class GameState {
     GameOver
 };
 
-struct Move {
-    int x1, y1, x2, y2;
-    char moved, captured;
-    bool wasEnPassant = false, wasCastling = false, wasPromotion = false;
-    int rookX1, rookY1, rookX2, rookY2;
-    bool oldCastleK[2], oldCastleQ[2];
-    std::pair<int, int> oldEnPassant;
+// Command-line switches for recording and replaying sessions
+struct GameOptions {
+    std::string recordPath;   // write every input event here
+    std::string replayPath;   // feed events from here instead of the user
+    std::string timingsPath;  // per-frame CSV written after a replay
+    bool offscreen = false;   // render into an sf::RenderTexture, no window
 };
 
 class Game {
 public:
-    Game();
+    explicit Game(const GameOptions &options = {});
+    ~Game();
     void run();
     void undoMove();
     void newGame();
+    void jumpToPly(int ply);
 
 private:
     sf::RenderWindow mWindow;
+    sf::RenderTexture offscreenTarget;
+    sf::RenderTarget *canvas = &mWindow;
     sf::RectangleShape board[BOARD_SIZE * BOARD_SIZE];
     sf::RectangleShape highlight;
     std::map<std::string, sf::Texture> pieceTextures;
@@ -59,42 +73,55 @@ private:
     sf::Text newGameText;
     sf::Text undoText;
     sf::Text exitText;
+    sf::RectangleShape moveListPanel;
+    sf::RectangleShape moveListCursor;
+    sf::Text moveListText;
+    sf::RectangleShape sliderTrack;
+    sf::RectangleShape sliderKnob;
+    sf::RectangleShape analyzeButton;
+    sf::Text analyzeText;
+    sf::RectangleShape evalGraphPanel;
 
-    char boardLogic[BOARD_SIZE][BOARD_SIZE];
-    bool whiteToMove = true;
-    bool canCastleK[2] = {true, true};
-    bool canCastleQ[2] = {true, true};
-    std::pair<int, int> enPassantTarget = {-1, -1};
-    std::vector<Move> moveHistory;
+    Position pos;
+    Timeline timeline;
+    int moveListFirstLine = 0;
+    bool isScrubbing = false;
+    GameAnalysis analysis;
+    // Declared before pendingAnalysis so it outlives the running analysis
+    std::atomic<bool> cancelAnalysis{false};
+    std::future<GameAnalysis> pendingAnalysis;
+    int historyVersion = 0, analysisVersion = -1;
     std::set<std::vector<int>> lastLegalMoves;
     bool isPieceSelected = false, isDragging = false;
     sf::Vector2i selectedSquare;
+    sf::Vector2i mousePos;
     GameState gameState = GameState::Menu;
 
-    void processEvent();
+    GameOptions options;
+    InputRecorder recorder;
+    InputReplay replay;
+    FrameStats frameStats;
+    std::vector<sf::Event> frameEvents;
+    long frameIndex = 0;
+    bool quitRequested = false;
+
+    int processEvent();
+    void handleEvent(const sf::Event &ev);
+    bool isRunning() const;
+    void present();
+    void quit();
     void update();
     void render();
     void loadTextures();
     void initSprites();
-    std::set<std::vector<int>> pseudoLegalMoves(bool white) const;
-    std::set<std::vector<int>> legalMoves();
-    bool inCheck(bool white) const;
-    bool isSquareAttacked(int x, int y, bool byWhite) const;
     void handleMoves(int x1, int y1, int x2, int y2);
+    int sliderPlyAt(int x) const;
+    void drawMoveList();
+    void drawEvalGraph();
+    void startAnalysis();
+    void pollAnalysis();
+    void historyChanged();
+    std::string moveText(const Move &m) const;
     void setupUI();
     void checkGameState();
-
-    inline bool inBounds(int x, int y) const { return x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE; }
-    inline bool isEmpty(int x, int y) const { return inBounds(x, y) && boardLogic[y][x] == ' '; }
-    inline bool sameColor(char a, char b) const {
-        if (a == ' ' || b == ' ') return false;
-        return (isupper(a) && isupper(b)) || (islower(a) && islower(b));
-    }
-    inline bool isWhite(char p) const { return isupper(p); }
-    inline bool isBlack(char p) const { return islower(p); }
-    inline bool isOpponent(int x, int y, bool white) const {
-        if (!inBounds(x, y)) return false;
-        char t = boardLogic[y][x];
-        return t != ' ' && (white ? islower(t) : isupper(t));
-    }
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "position.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+constexpr uint8_t NO_SQUARE = 0xFF;
+
+// Fixed-size training record. Squares are indexed y * 8 + x (a8 first),
+// score and result are from White's point of view.
+struct PackedPosition {
+    uint8_t board[32];   // one nibble per square, low nibble first
+    uint8_t flags;       // bit 0 white to move, bits 1-4 castling K Q k q
+    uint8_t enPassant;   // target square or NO_SQUARE
+    int16_t score;       // centipawns
+    int8_t result;       // 1 white win, 0 draw, -1 black win
+    uint8_t reserved[3];
+};
+static_assert(sizeof(PackedPosition) == 40, "PackedPosition must stay 40 bytes on disk");
+
+PackedPosition pack(const Position &pos, int score, int result);
+void unpack(const PackedPosition &rec, Position &pos);
+
+// Writes records to a new file (replacing any existing one) in batches to
+// keep syscalls rare.
+class PackedWriter {
+public:
+    explicit PackedWriter(const std::string &path, size_t batchSize = 4096);
+    ~PackedWriter();
+    PackedWriter(const PackedWriter &) = delete;
+    PackedWriter &operator=(const PackedWriter &) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    void write(const PackedPosition &rec);
+    void flush();
+
+private:
+    FILE *file = nullptr;
+    size_t batchSize;
+    std::vector<PackedPosition> buffer;
+};
+
+// Read-only memory-mapped view of a record file, for streaming consumers.
+class PackedReader {
+public:
+    explicit PackedReader(const std::string &path);
+    ~PackedReader();
+    PackedReader(const PackedReader &) = delete;
+    PackedReader &operator=(const PackedReader &) = delete;
+
+    bool isOpen() const { return opened; }
+    size_t size() const { return count; }
+    const PackedPosition &operator[](size_t i) const { return data[i]; }
+    const PackedPosition *begin() const { return data; }
+    const PackedPosition *end() const { return data + count; }
+
+private:
+    const PackedPosition *data = nullptr;
+    size_t count = 0;
+    size_t mappedBytes = 0;
+    bool opened = false;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <set>
+#include <string>
+#include <utility>
+#include <cctype>
+
+// Board geometry and rule constants
+constexpr int BOARD_SIZE = 8;
+constexpr int WHITE_PAWN_START_ROW = 6;
+constexpr int BLACK_PAWN_START_ROW = 1;
+constexpr int WHITE_BACK_ROW = 7;
+constexpr int BLACK_BACK_ROW = 0;
+constexpr int MAX_MOVES = 256;
+constexpr int SEE_KING_VALUE = 20000;
+
+inline int pieceValue(char p) {
+    switch (tolower(p)) {
+        case 'p': return 100;
+        case 'n': return 320;
+        case 'b': return 330;
+        case 'r': return 500;
+        case 'q': return 900;
+        default:  return 0;
+    }
+}
+
+struct Move {
+    int x1, y1, x2, y2;
+    char moved, captured;
+    bool wasEnPassant = false, wasCastling = false, wasPromotion = false;
+    int rookX1, rookY1, rookX2, rookY2;
+    bool oldCastleK[2], oldCastleQ[2];
+    std::pair<int, int> oldEnPassant;
+};
+
+// Compact generator move; squares are indexed y * 8 + x
+struct GenMove {
+    uint8_t from, to;
+    int x1() const { return from % BOARD_SIZE; }
+    int y1() const { return from / BOARD_SIZE; }
+    int x2() const { return to % BOARD_SIZE; }
+    int y2() const { return to / BOARD_SIZE; }
+};
+
+struct MoveList {
+    GenMove moves[MAX_MOVES];
+    int count = 0;
+
+    void add(int from, int to) { moves[count++] = {static_cast<uint8_t>(from), static_cast<uint8_t>(to)}; }
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+    GenMove &operator[](int i) { return moves[i]; }
+    const GenMove *begin() const { return moves; }
+    const GenMove *end() const { return moves + count; }
+};
+
+// Board state and chess rules, independent of any window so that headless
+// tools (data generation, analysis) can share them with the GUI.
+class Position {
+public:
+    char boardLogic[BOARD_SIZE][BOARD_SIZE];
+    bool whiteToMove = true;
+    bool canCastleK[2] = {true, true};
+    bool canCastleQ[2] = {true, true};
+    std::pair<int, int> enPassantTarget = {-1, -1};
+
+    Position() { reset(); }
+    void reset();
+    // Loads a FEN string; returns false and leaves the position unspecified
+    // if it is malformed.
+    bool setFen(const std::string &fen);
+
+    // Fast generator interface, used by search and tools
+    void generatePseudo(MoveList &out) const;
+    void generateLegal(MoveList &out);
+    bool isLegal(GenMove mv);
+
+    // Static exchange evaluation: material the mover expects to net on the
+    // destination square if both sides keep recapturing with their least
+    // valuable attacker, x-rays included. Pins are ignored, and knights and
+    // bishops are worth the same.
+    int see(GenMove mv) const;
+
+    // {x1, y1, x2, y2} sets, used by the GUI
+    std::set<std::vector<int>> pseudoLegalMoves(bool white) const;
+    std::set<std::vector<int>> legalMoves();
+    bool inCheck(bool white) const;
+    bool isSquareAttacked(int x, int y, bool byWhite) const;
+
+    // Plays a move without checking legality and returns the record
+    // needed to take it back.
+    Move makeMove(int x1, int y1, int x2, int y2);
+    Move makeMove(GenMove mv) { return makeMove(mv.x1(), mv.y1(), mv.x2(), mv.y2()); }
+    void unmakeMove(const Move &m);
+
+    // Standard algebraic notation for a legal move in this position
+    std::string toSan(int x1, int y1, int x2, int y2);
+
+    inline bool inBounds(int x, int y) const { return x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE; }
+    inline bool isEmpty(int x, int y) const { return inBounds(x, y) && boardLogic[y][x] == ' '; }
+    inline bool sameColor(char a, char b) const {
+        if (a == ' ' || b == ' ') return false;
+        return (isupper(a) && isupper(b)) || (islower(a) && islower(b));
+    }
+    inline bool isWhite(char p) const { return isupper(p); }
+    inline bool isBlack(char p) const { return islower(p); }
+    inline bool isOpponent(int x, int y, bool white) const {
+        if (!inBounds(x, y)) return false;
+        char t = boardLogic[y][x];
+        return t != ' ' && (white ? islower(t) : isupper(t));
+    }
+
+private:
+    // Specialized per side so pawn direction, start row and castling
+    // squares are compile-time constants.
+    template <bool White> void generate(MoveList &out) const;
+    template <bool ByWhite> bool attacked(int sq) const;
+};
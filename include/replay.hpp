@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Input events tagged with the frame they were delivered in. Replaying
+// them frame by frame reproduces a session without the real mouse.
+struct RecordedEvent {
+    long frame;
+    sf::Event event;
+};
+
+class InputRecorder {
+public:
+    bool open(const std::string &path);
+    bool isOpen() const { return out.is_open(); }
+    void record(long frame, const sf::Event &ev);
+
+private:
+    std::ofstream out;
+};
+
+class InputReplay {
+public:
+    bool load(const std::string &path);
+    // Appends the events recorded for this frame
+    void eventsForFrame(long frame, std::vector<sf::Event> &out);
+    bool finished(long frame) const { return next >= events.size() && frame > lastFrame; }
+
+private:
+    std::vector<RecordedEvent> events;
+    size_t next = 0;
+    long lastFrame = -1;
+};
+
+// Per-frame timings; frames that delivered input also count towards the
+// input-to-present latency distribution.
+class FrameStats {
+public:
+    void add(double frameMs, int inputEvents);
+    void report(std::ostream &os) const;
+    bool writeCsv(const std::string &path) const;
+
+private:
+    std::vector<double> frameMs;
+    std::vector<int> inputs;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "position.hpp"
+#include <atomic>
+#include <vector>
+
+constexpr int MATE_SCORE = 30000;
+constexpr int INF_SCORE = 32000;
+
+// Static evaluation in centipawns from the side to move's point of view
+int evaluate(const Position &pos);
+
+// Captures-only search used to settle tactical noise at the horizon
+int quiesce(Position &pos, int alpha, int beta);
+int alphaBeta(Position &pos, int depth, int alpha, int beta, int ply = 0);
+
+// Fixed-depth search from the root. Fills best with {x1, y1, x2, y2} and
+// returns its score from the side to move's point of view.
+int searchRoot(Position &pos, int depth, std::vector<int> &best);
+
+// Iterative deepening until budgetMs has elapsed or *cancel is set; returns
+// the score of the deepest completed iteration. Safe to call from several
+// threads at once.
+int searchTimed(Position &pos, int budgetMs, std::vector<int> &best, int maxDepth = 64,
+                const std::atomic<bool> *cancel = nullptr);
+
+inline bool isCapture(const Position &pos, GenMove mv) {
+    char pc = pos.boardLogic[mv.y1()][mv.x1()];
+    return pos.boardLogic[mv.y2()][mv.x2()] != ' ' || (tolower(pc) == 'p' && mv.x1() != mv.x2());
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "position.hpp"
+#include <vector>
+
+constexpr int CHECKPOINT_INTERVAL = 8;   // plies between full position snapshots
+constexpr int MAX_CHECKPOINTS = 64;      // interval doubles when exceeded
+
+// The moves of the current line plus full position copies every interval
+// plies, so any ply can be reached with one restore and a few replayed
+// moves. The caller owns the live position; every call leaves it at ply().
+class Timeline {
+public:
+    void reset(const Position &start);
+    // Plays a legal move at the current ply; any later continuation is dropped.
+    void play(Position &pos, int x1, int y1, int x2, int y2);
+    // Takes back the move before the current ply, dropping the continuation.
+    // Returns false if there was nothing to change.
+    bool undo(Position &pos);
+    void jumpTo(Position &pos, int ply);
+
+    int ply() const { return currentPly; }
+    int size() const { return static_cast<int>(moves.size()); }
+    const std::vector<Move> &history() const { return moves; }
+    const Position &start() const { return checkpoints.front(); }
+
+private:
+    std::vector<Move> moves;
+    std::vector<Position> checkpoints;
+    int checkpointInterval = CHECKPOINT_INTERVAL;
+    int currentPly = 0;
+
+    void recordCheckpoint(const Position &pos);
+    void truncate(int ply);
+};
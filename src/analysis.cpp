@@ -0,0 +1,128 @@
+#include "analysis.hpp"
+#include "search.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// Mate scores are capped so a missed mate counts as a large but finite loss
+constexpr int EVAL_CAP = 1500;
+
+GameAnalysis analyzeGame(const Position &start, const std::vector<Move> &moves,
+                         int threads, int budgetMs, const std::atomic<bool> *cancel) {
+    GameAnalysis out;
+    size_t n = moves.size();
+
+    // Replaying is cheap; only the searches are spread over the pool.
+    std::vector<Position> positions;
+    positions.reserve(n + 1);
+    positions.push_back(start);
+    out.plies.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        Position p = positions.back();
+        const Move &m = moves[i];
+        out.plies[i].san = p.toSan(m.x1, m.y1, m.x2, m.y2);
+        p.makeMove(m.x1, m.y1, m.x2, m.y2);
+        positions.push_back(p);
+    }
+
+    out.evals.assign(n + 1, 0);
+    std::vector<std::vector<int>> best(n + 1);
+    std::atomic<size_t> next{0};
+    auto cancelled = [&] { return cancel && cancel->load(std::memory_order_relaxed); };
+    auto work = [&] {
+        for (size_t i = next++; i <= n && !cancelled(); i = next++) {
+            Position p = positions[i];
+            int score = std::clamp(searchTimed(p, budgetMs, best[i], 64, cancel), -EVAL_CAP, EVAL_CAP);
+            out.evals[i] = p.whiteToMove ? score : -score;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 0; t < std::max(1, threads); ++t)
+        pool.emplace_back(work);
+    for (auto &t : pool)
+        t.join();
+    if (cancelled())
+        return out;
+
+    for (size_t i = 0; i < n; ++i) {
+        PlyAnalysis &pa = out.plies[i];
+        bool white = positions[i].whiteToMove;
+        pa.loss = std::max(0, white ? out.evals[i] - out.evals[i + 1] : out.evals[i + 1] - out.evals[i]);
+        // The engine's own choice is never marked, whatever the horizon says
+        const Move &m = moves[i];
+        if (best[i] == std::vector<int>{m.x1, m.y1, m.x2, m.y2})
+            pa.loss = 0;
+        pa.mark = pa.loss >= BLUNDER_LOSS  ? Annotation::Blunder
+                : pa.loss >= MISTAKE_LOSS  ? Annotation::Mistake
+                : pa.loss >= INACCURACY_LOSS ? Annotation::Inaccuracy
+                                             : Annotation::None;
+        if (pa.mark != Annotation::None && !best[i].empty())
+            pa.bestSan = positions[i].toSan(best[i][0], best[i][1], best[i][2], best[i][3]);
+    }
+
+    Position &last = positions.back();
+    if (!last.legalMoves().empty())
+        out.result = "*";
+    else if (last.inCheck(last.whiteToMove))
+        out.result = last.whiteToMove ? "0-1" : "1-0";
+    else
+        out.result = "1/2-1/2";
+    out.complete = true;
+    return out;
+}
+
+std::string annotationSymbol(Annotation a) {
+    switch (a) {
+        case Annotation::Inaccuracy: return "?!";
+        case Annotation::Mistake:    return "?";
+        case Annotation::Blunder:    return "??";
+        default:                     return "";
+    }
+}
+
+static std::string pawns(int cp) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%+.2f", cp / 100.0);
+    return buf;
+}
+
+std::string toPgn(const GameAnalysis &analysis) {
+    std::string pgn;
+    pgn += "[Event \"Casual Game\"]\n[Site \"?\"]\n[Date \"????.??.??\"]\n[Round \"-\"]\n";
+    pgn += "[White \"White\"]\n[Black \"Black\"]\n";
+    pgn += "[Result \"" + analysis.result + "\"]\n[Annotator \"chessgame\"]\n\n";
+
+    std::string line;
+    auto emit = [&](const std::string &tok) {
+        if (line.size() + tok.size() + 1 > 80) {
+            pgn += line + "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + tok;
+    };
+    for (size_t i = 0; i < analysis.plies.size(); ++i) {
+        const PlyAnalysis &pa = analysis.plies[i];
+        // Every move carries a comment, so Black's moves need "N..." too
+        emit(std::to_string(i / 2 + 1) + (i % 2 == 0 ? "." : "..."));
+        emit(pa.san + annotationSymbol(pa.mark));
+        std::string comment = "{" + pawns(analysis.evals[i + 1]);
+        if (!pa.bestSan.empty())
+            comment += ", best was " + pa.bestSan;
+        emit(comment + "}");
+    }
+    emit(analysis.result);
+    return pgn + line + "\n";
+}
+
+bool exportPgn(const GameAnalysis &analysis, const std::string &path) {
+    std::ofstream f(path);
+    if (!f) {
+        std::cerr << "Failed to write " << path << "\n";
+        return false;
+    }
+    f << toPgn(analysis);
+    return true;
+}
@@ -0,0 +1,476 @@
+// Move generator benchmark: checks perft node counts against known values
+// and reports nodes per second for the MoveList generator, the std::set
+// interface the GUI uses and the old runtime-branching generator. Also
+// checks and times Position::see and checks that timeline jumps land on the
+// same board as the live game.
+//
+// Promotions always make a queen here, so only depths without
+// promotions are compared against the standard tables.
+#include "position.hpp"
+#include "search.hpp"
+#include "timeline.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+struct PerftCase {
+    const char *name;
+    const char *fen;
+    std::vector<uint64_t> expected;   // depth 1, 2, ...
+};
+
+static uint64_t perft(Position &pos, int depth) {
+    MoveList list;
+    pos.generateLegal(list);
+    if (depth == 1)
+        return list.size();
+    uint64_t nodes = 0;
+    for (auto mv : list) {
+        Move m = pos.makeMove(mv);
+        nodes += perft(pos, depth - 1);
+        pos.unmakeMove(m);
+    }
+    return nodes;
+}
+
+static uint64_t perftSets(Position &pos, int depth) {
+    auto moves = pos.legalMoves();
+    if (depth == 1)
+        return moves.size();
+    uint64_t nodes = 0;
+    for (auto &mv : moves) {
+        Move m = pos.makeMove(mv[0], mv[1], mv[2], mv[3]);
+        nodes += perftSets(pos, depth - 1);
+        pos.unmakeMove(m);
+    }
+    return nodes;
+}
+
+// The runtime-branching generator the templated one replaced, kept as a
+// baseline: one loop for both sides, tolower/isWhite per square and
+// std::set output.
+namespace reference {
+
+static bool isSquareAttacked(const Position &pos, int x, int y, bool byWhite) {
+    auto own = [&](int nx, int ny, char lower) {
+        return pos.inBounds(nx, ny) && pos.boardLogic[ny][nx] == (byWhite ? toupper(lower) : lower);
+    };
+
+    int py = y + (byWhite ? 1 : -1);
+    if (own(x - 1, py, 'p') || own(x + 1, py, 'p'))
+        return true;
+
+    const int DX[8] = {1, 2, 2, 1, -1, -2, -2, -1};
+    const int DY[8] = {-2, -1, 1, 2, 2, 1, -1, -2};
+    for (int i = 0; i < 8; ++i)
+        if (own(x + DX[i], y + DY[i], 'n'))
+            return true;
+
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            if (dx == 0 && dy == 0) continue;
+            if (own(x + dx, y + dy, 'k'))
+                return true;
+            bool diagonal = dx != 0 && dy != 0;
+            for (int i = 1; i < BOARD_SIZE; ++i) {
+                int nx = x + dx * i, ny = y + dy * i;
+                if (!pos.inBounds(nx, ny)) break;
+                if (pos.boardLogic[ny][nx] == ' ') continue;
+                if (own(nx, ny, 'q') || own(nx, ny, diagonal ? 'b' : 'r'))
+                    return true;
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+static bool inCheck(const Position &pos, bool white) {
+    int kx = -1, ky = -1;
+    for (int y = 0; y < BOARD_SIZE; ++y) {
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            if (pos.boardLogic[y][x] == (white ? 'K' : 'k')) {
+                kx = x;
+                ky = y;
+            }
+        }
+    }
+    if (kx == -1) return false;
+    return isSquareAttacked(pos, kx, ky, !white);
+}
+
+static std::set<std::vector<int>> pseudoLegalMoves(const Position &pos, bool w) {
+    std::set<std::vector<int>> M;
+    for (int y = 0; y < BOARD_SIZE; ++y) {
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            char p = pos.boardLogic[y][x];
+            if (p == ' ' || (w != pos.isWhite(p)))
+                continue;
+
+            int dir = pos.isWhite(p) ? -1 : 1;
+
+            switch (tolower(p)) {
+                case 'p': {
+                    int ny = y + dir;
+                    if (pos.inBounds(x, ny) && pos.isEmpty(x, ny))
+                        M.insert({x, y, x, ny});
+                    if (((pos.isWhite(p) && y == WHITE_PAWN_START_ROW) || 
+                         (pos.isBlack(p) && y == BLACK_PAWN_START_ROW))) {
+                        int ny2 = y + 2 * dir;
+                        if (pos.inBounds(x, ny2) && pos.isEmpty(x, ny) && pos.isEmpty(x, ny2))
+                            M.insert({x, y, x, ny2});
+                    }
+                    if (pos.isOpponent(x - 1, ny, w))
+                        M.insert({x, y, x - 1, ny});
+                    if (pos.isOpponent(x + 1, ny, w))
+                        M.insert({x, y, x + 1, ny});
+                    int ex = pos.enPassantTarget.first, ey = pos.enPassantTarget.second;
+                    if (pos.inBounds(ex, ey) && ey == y + dir && abs(ex - x) == 1 && pos.boardLogic[y][ex] != ' ') {
+                        M.insert({x, y, ex, ey});
+                    }
+                    break;
+                }
+                case 'n': {
+                    const int DX[8] = {1, 2, 2, 1, -1, -2, -2, -1};
+                    const int DY[8] = {-2, -1, 1, 2, 2, 1, -1, -2};
+                    for (int i = 0; i < 8; ++i) {
+                        int nx = x + DX[i], ny = y + DY[i];
+                        if (pos.inBounds(nx, ny) && !pos.sameColor(p, pos.boardLogic[ny][nx]))
+                            M.insert({x, y, nx, ny});
+                    }
+                    break;
+                }
+                case 'b': {
+                    for (int dx : {-1, 1}) {
+                        for (int dy : {-1, 1}) {
+                            for (int i = 1; i < BOARD_SIZE; ++i) {
+                                int nx = x + dx * i, ny = y + dy * i;
+                                if (!pos.inBounds(nx, ny)) break;
+                                if (pos.boardLogic[ny][nx] == ' ') {
+                                    M.insert({x, y, nx, ny});
+                                } else {
+                                    if (pos.isOpponent(nx, ny, w))
+                                        M.insert({x, y, nx, ny});
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                    break;
+                }
+                case 'r': {
+                    for (int d : {-1, 1}) {
+                        for (int i = 1; i < BOARD_SIZE; ++i) {
+                            int nx = x + d * i;
+                            if (!pos.inBounds(nx, y)) break;
+                            if (pos.boardLogic[y][nx] == ' ') {
+                                M.insert({x, y, nx, y});
+                            } else {
+                                if (pos.isOpponent(nx, y, w))
+                                    M.insert({x, y, nx, y});
+                                break;
+                            }
+                        }
+                        for (int i = 1; i < BOARD_SIZE; ++i) {
+                            int ny = y + d * i;
+                            if (!pos.inBounds(x, ny)) break;
+                            if (pos.boardLogic[ny][x] == ' ') {
+                                M.insert({x, y, x, ny});
+                            } else {
+                                if (pos.isOpponent(x, ny, w))
+                                    M.insert({x, y, x, ny});
+                                break;
+                            }
+                        }
+                    }
+                    break;
+                }
+                case 'q': {
+                    for (int dx : {-1, 1}) {
+                        for (int dy : {-1, 1}) {
+                            for (int i = 1; i < BOARD_SIZE; ++i) {
+                                int nx = x + dx * i, ny = y + dy * i;
+                                if (!pos.inBounds(nx, ny)) break;
+                                if (pos.boardLogic[ny][nx] == ' ') {
+                                    M.insert({x, y, nx, ny});
+                                } else {
+                                    if (pos.isOpponent(nx, ny, w))
+                                        M.insert({x, y, nx, ny});
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                    for (int d : {-1, 1}) {
+                        for (int i = 1; i < BOARD_SIZE; ++i) {
+                            int nx = x + d * i;
+                            if (!pos.inBounds(nx, y)) break;
+                            if (pos.boardLogic[y][nx] == ' ') {
+                                M.insert({x, y, nx, y});
+                            } else {
+                                if (pos.isOpponent(nx, y, w))
+                                    M.insert({x, y, nx, y});
+                                break;
+                            }
+                        }
+                        for (int i = 1; i < BOARD_SIZE; ++i) {
+                            int ny = y + d * i;
+                            if (!pos.inBounds(x, ny)) break;
+                            if (pos.boardLogic[ny][x] == ' ') {
+                                M.insert({x, y, x, ny});
+                            } else {
+                                if (pos.isOpponent(x, ny, w))
+                                    M.insert({x, y, x, ny});
+                                break;
+                            }
+                        }
+                    }
+                    break;
+                }
+                case 'k': {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        for (int dy = -1; dy <= 1; ++dy) {
+                            if (dx == 0 && dy == 0) continue;
+                            int nx = x + dx, ny = y + dy;
+                            if (pos.inBounds(nx, ny) && !pos.sameColor(p, pos.boardLogic[ny][nx]))
+                                M.insert({x, y, nx, ny});
+                        }
+                    }
+                    int row = w ? WHITE_BACK_ROW : BLACK_BACK_ROW;
+                    if (pos.canCastleK[w] && pos.boardLogic[row][5] == ' ' && pos.boardLogic[row][6] == ' ') {
+                        M.insert({4, row, 6, row});
+                    }
+                    if (pos.canCastleQ[w] && pos.boardLogic[row][3] == ' ' && pos.boardLogic[row][2] == ' ' && pos.boardLogic[row][1] == ' ') {
+                        M.insert({4, row, 2, row});
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    return M;
+}
+
+static std::set<std::vector<int>> legalMoves(Position &pos) {
+    auto P = pseudoLegalMoves(pos, pos.whiteToMove);
+    std::set<std::vector<int>> L;
+    for (auto &mv : P) {
+        int x1 = mv[0], y1 = mv[1], x2 = mv[2], y2 = mv[3];
+        char pc = pos.boardLogic[y1][x1], cap = pos.boardLogic[y2][x2];
+        bool isKingMove = (tolower(pc) == 'k');
+        bool isCastling = (isKingMove && abs(x2 - x1) == 2);
+
+        if (isCastling) {
+            if (inCheck(pos, pos.whiteToMove))
+                continue;
+            int passX = (x1 + x2) / 2;
+            if (isSquareAttacked(pos, passX, y1, !pos.whiteToMove))
+                continue;
+            if (isSquareAttacked(pos, x2, y2, !pos.whiteToMove))
+                continue;
+        }
+
+        pos.boardLogic[y2][x2] = pc;
+        pos.boardLogic[y1][x1] = ' ';
+        bool ep = (tolower(pc) == 'p' && x2 != x1 && cap == ' ');
+        char epCap = ' ';
+        if (ep) {
+            epCap = pos.boardLogic[y1][x2];
+            pos.boardLogic[y1][x2] = ' ';
+        }
+
+        bool safe = !inCheck(pos, pos.whiteToMove);
+        pos.boardLogic[y1][x1] = pc;
+        pos.boardLogic[y2][x2] = cap;
+        if (ep)
+            pos.boardLogic[y1][x2] = epCap;
+
+        if (safe)
+            L.insert(mv);
+    }
+    return L;
+}
+
+static uint64_t perft(Position &pos, int depth) {
+    auto moves = legalMoves(pos);
+    if (depth == 1)
+        return moves.size();
+    uint64_t nodes = 0;
+    for (auto &mv : moves) {
+        Move m = pos.makeMove(mv[0], mv[1], mv[2], mv[3]);
+        nodes += reference::perft(pos, depth - 1);
+        pos.unmakeMove(m);
+    }
+    return nodes;
+}
+
+} // namespace reference
+
+struct SeeCase {
+    const char *fen;
+    const char *move;   // from and to square, e.g. "e1e5"
+    int expected;
+};
+
+static GenMove parseMove(const char *m) {
+    int x1 = m[0] - 'a', y1 = BOARD_SIZE - (m[1] - '0');
+    int x2 = m[2] - 'a', y2 = BOARD_SIZE - (m[3] - '0');
+    return {static_cast<uint8_t>(y1 * BOARD_SIZE + x1), static_cast<uint8_t>(y2 * BOARD_SIZE + x2)};
+}
+
+static bool samePosition(const Position &a, const Position &b) {
+    return !memcmp(a.boardLogic, b.boardLogic, sizeof(a.boardLogic)) && a.whiteToMove == b.whiteToMove &&
+           a.canCastleK[0] == b.canCastleK[0] && a.canCastleK[1] == b.canCastleK[1] &&
+           a.canCastleQ[0] == b.canCastleQ[0] && a.canCastleQ[1] == b.canCastleQ[1] &&
+           a.enPassantTarget == b.enPassantTarget;
+}
+
+static Position replayTo(const Timeline &t, int ply) {
+    Position p = t.start();
+    for (int i = 0; i < ply; ++i) {
+        const Move &m = t.history()[i];
+        p.makeMove(m.x1, m.y1, m.x2, m.y2);
+    }
+    return p;
+}
+
+static void playRandom(Timeline &t, Position &pos, std::mt19937 &rng) {
+    MoveList list;
+    pos.generateLegal(list);
+    if (list.empty())
+        return;
+    GenMove mv = list[rng() % list.size()];
+    t.play(pos, mv.x1(), mv.y1(), mv.x2(), mv.y2());
+}
+
+// Undo at a checkpoint ply, play a different move, then jump away and
+// back; followed by random play, undo and jumps checked against a replay
+// from the start.
+static bool checkTimeline() {
+    Timeline t;
+    Position pos;
+    t.reset(pos);
+    std::mt19937 rng(7);
+    while (t.ply() < CHECKPOINT_INTERVAL)
+        playRandom(t, pos, rng);
+    t.undo(pos);
+    playRandom(t, pos, rng);
+    Position live = pos;
+    t.jumpTo(pos, 0);
+    t.jumpTo(pos, CHECKPOINT_INTERVAL);
+    if (!samePosition(pos, live)) {
+        printf("timeline: undo at ply %d left a stale checkpoint\n", CHECKPOINT_INTERVAL);
+        return false;
+    }
+
+    for (int step = 0; step < 20000; ++step) {
+        int op = rng() % 8;
+        if (op < 4)
+            playRandom(t, pos, rng);
+        else if (op < 6)
+            t.undo(pos);
+        else
+            t.jumpTo(pos, rng() % (t.size() + 1));
+        if (!samePosition(pos, replayTo(t, t.ply()))) {
+            printf("timeline: step %d, ply %d of %d differs from replay\n", step, t.ply(), t.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename F>
+static double timed(F &&f, uint64_t &nodes) {
+    auto start = std::chrono::steady_clock::now();
+    nodes = f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const PerftCase cases[] = {
+        {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -",
+         {20, 400, 8902, 197281, 4865609}},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+         {48, 2039, 97862}},
+        {"endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+         {14, 191, 2812, 43238, 674624}},
+    };
+
+    bool ok = true;
+    for (auto &c : cases) {
+        Position pos;
+        if (!pos.setFen(c.fen)) {
+            printf("%s: bad FEN\n", c.name);
+            return 1;
+        }
+        for (size_t d = 1; d <= c.expected.size(); ++d) {
+            uint64_t nodes;
+            double s = timed([&] { return perft(pos, d); }, nodes);
+            bool match = nodes == c.expected[d - 1];
+            ok &= match;
+            printf("%-9s depth %zu: %10llu %s  %.3f s  %.2f Mnps\n", c.name, d,
+                   static_cast<unsigned long long>(nodes), match ? "ok      " : "MISMATCH", s, nodes / s / 1e6);
+        }
+    }
+
+    const SeeCase seeCases[] = {
+        {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - -", "e1e5", 100},            // free pawn
+        {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - -", "d3e5", -220}, // x-rays on both sides
+        {"4k3/8/8/3p4/4P3/8/8/4K3 w - -", "e4d5", 100},                         // pawn trade
+        {"4k3/8/2p5/3p4/8/8/3Q4/3RK3 w - -", "d2d5", -700},                     // queen takes defended pawn
+        {"4k3/8/8/3r4/8/8/3R4/3RK3 w - -", "d2d5", 500},                        // battery wins rook
+        {"4k3/8/2p5/3n4/8/1B6/8/4K3 w - -", "b3d5", 0},                         // bishop for knight
+        {"4k3/B7/2n5/8/8/4K3/8/8 w - -", "a7d4", 0},                             // bishop offered to a knight, defended
+    };
+    for (auto &c : seeCases) {
+        Position pos;
+        pos.setFen(c.fen);
+        int got = pos.see(parseMove(c.move));
+        ok &= got == c.expected;
+        printf("see %s %-52s %5d %s\n", c.move, c.fen, got, got == c.expected ? "ok" : "MISMATCH");
+    }
+
+    bool timelineOk = checkTimeline();
+    ok &= timelineOk;
+    printf("timeline %s\n", timelineOk ? "ok" : "MISMATCH");
+
+    // Time SEE over every capture in a busy middlegame
+    {
+        Position pos;
+        pos.setFen(cases[1].fen);
+        MoveList list, captures;
+        pos.generateLegal(list);
+        for (auto mv : list)
+            if (isCapture(pos, mv))
+                captures.add(mv.from, mv.to);
+        const int rounds = 1000000;
+        long long sink = 0, calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (auto mv : captures) {
+                sink += pos.see(mv);
+                ++calls;
+            }
+        }
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("see: %.0f ns/call over %lld calls on %d captures (checksum %lld)\n", s / calls * 1e9, calls,
+               captures.size(), sink);
+    }
+
+    // Same tree through both interfaces and through the old generator
+    Position pos;
+    uint64_t listNodes, setNodes, refNodes;
+    double listTime = timed([&] { return perft(pos, 5); }, listNodes);
+    double setTime = timed([&] { return perftSets(pos, 5); }, setNodes);
+    double refTime = timed([&] { return reference::perft(pos, 5); }, refNodes);
+    ok &= setNodes == listNodes && refNodes == listNodes;
+    printf("\nstart perft 5: MoveList %.2f Mnps, std::set %.2f Mnps, reference %.2f Mnps\n",
+           listNodes / listTime / 1e6, setNodes / setTime / 1e6, refNodes / refTime / 1e6);
+    printf("speedup over reference: MoveList %.1fx, std::set %.1fx\n", refTime / listTime, refTime / setTime);
+
+    return ok ? 0 : 1;
+}
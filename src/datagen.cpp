@@ -0,0 +1,244 @@
+// Headless self-play generator for evaluation training data.
+//
+//   ./datagen [-t threads] [-n positions] [-d depth] [-o prefix] [-s seed]
+//   ./datagen --inspect file.bin
+//
+// Every thread plays its own games and writes to its own shard
+// (<prefix>-<thread>.bin), so workers never contend on a file or lock.
+// Existing shards are never touched: a second run with the same prefix
+// would repeat the same games, so it is refused.
+#include "packed.hpp"
+#include "search.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr int RANDOM_OPENING_PLIES = 8;
+constexpr int MAX_GAME_PLIES = 300;
+constexpr int RANDOM_MOVE_PERCENT = 10;
+constexpr int ADJUDICATE_SCORE = 2000;
+// Shallow self-play often shuffles a won ending until a draw rule or
+// MAX_GAME_PLIES ends it. Such games go to the side this far ahead; close
+// games cut off by the ply cap are dropped rather than labelled draws.
+constexpr int WON_ENDING_SCORE = 400;
+constexpr int FIFTY_MOVE_PLIES = 100;
+
+struct Options {
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    long long positions = 100000;
+    int depth = 2;
+    std::string prefix = "selfplay";
+    unsigned long long seed = 1;
+};
+
+static std::atomic<long long> produced{0};
+static std::atomic<long long> gamesPlayed{0};
+static std::atomic<int> running{0};
+
+template <typename Rng>
+static std::vector<int> randomMove(MoveList &moves, Rng &rng) {
+    GenMove mv = moves[std::uniform_int_distribution<int>(0, moves.size() - 1)(rng)];
+    return {mv.x1(), mv.y1(), mv.x2(), mv.y2()};
+}
+
+static bool onlyKings(const Position &pos) {
+    for (int y = 0; y < BOARD_SIZE; ++y)
+        for (int x = 0; x < BOARD_SIZE; ++x)
+            if (pos.boardLogic[y][x] != ' ' && tolower(pos.boardLogic[y][x]) != 'k')
+                return false;
+    return true;
+}
+
+// Board, side to move, castling and en passant: the packed record up to the score
+using PositionKey = std::array<uint8_t, offsetof(PackedPosition, score)>;
+
+static PositionKey positionKey(const Position &pos) {
+    PackedPosition rec = pack(pos, 0, 0);
+    PositionKey key;
+    memcpy(key.data(), &rec, key.size());
+    return key;
+}
+
+static std::string shardPath(const Options &opt, int id) {
+    return opt.prefix + "-" + std::to_string(id) + ".bin";
+}
+
+static void worker(int id, const Options &opt, PackedWriter &out) {
+    std::mt19937_64 rng(opt.seed * 1000003 + id);
+    std::uniform_int_distribution<int> percent(0, 99);
+    Position pos;
+    std::vector<PackedPosition> game;
+    std::vector<int> best;
+    MoveList moves;
+
+    while (produced.load(std::memory_order_relaxed) < opt.positions) {
+        pos.reset();
+        game.clear();
+        // Odd/even opening length varies which side moves first after the book
+        int openingPlies = RANDOM_OPENING_PLIES + static_cast<int>(rng() % 2);
+        int result = 0, lastScore = 0;
+        bool decided = false, drawRule = false;
+        // Positions since the last pawn move or capture, for repetitions
+        std::vector<PositionKey> seen{positionKey(pos)};
+
+        for (int ply = 0; ply < MAX_GAME_PLIES; ++ply) {
+            pos.generateLegal(moves);
+            if (moves.empty()) {
+                if (pos.inCheck(pos.whiteToMove))
+                    result = pos.whiteToMove ? -1 : 1;
+                decided = true;
+                break;
+            }
+            if (onlyKings(pos)) {
+                decided = true;
+                break;
+            }
+            if (seen.size() > FIFTY_MOVE_PLIES || std::count(seen.begin(), seen.end(), seen.back()) >= 3) {
+                drawRule = true;
+                break;
+            }
+
+            std::vector<int> mv;
+            if (ply < openingPlies) {
+                mv = randomMove(moves, rng);
+            } else {
+                int score = searchRoot(pos, opt.depth, best);
+                lastScore = pos.whiteToMove ? score : -score;
+                if (std::abs(score) >= ADJUDICATE_SCORE) {
+                    result = lastScore > 0 ? 1 : -1;
+                    decided = true;
+                    break;
+                }
+                // Keep only quiet positions: no check and nothing tactical
+                // left for the capture search to resolve.
+                if (!pos.inCheck(pos.whiteToMove) && quiesce(pos, -INF_SCORE, INF_SCORE) == evaluate(pos))
+                    game.push_back(pack(pos, lastScore, 0));
+                mv = percent(rng) < RANDOM_MOVE_PERCENT ? randomMove(moves, rng) : best;
+            }
+            Move m = pos.makeMove(mv[0], mv[1], mv[2], mv[3]);
+            if (tolower(m.moved) == 'p' || m.captured != ' ')
+                seen.clear();
+            seen.push_back(positionKey(pos));
+        }
+        if (!decided) {
+            if (std::abs(lastScore) >= WON_ENDING_SCORE)
+                result = lastScore > 0 ? 1 : -1;
+            else if (!drawRule)
+                game.clear();
+        }
+
+        for (auto &rec : game) {
+            rec.result = static_cast<int8_t>(result);
+            out.write(rec);
+        }
+        produced += game.size();
+        ++gamesPlayed;
+    }
+    out.flush();
+    --running;
+}
+
+static int inspect(const std::string &path) {
+    PackedReader in(path);
+    if (!in.isOpen())
+        return 1;
+    long long results[3] = {0, 0, 0};
+    long long absScore = 0;
+    for (auto &rec : in) {
+        if (rec.result < -1 || rec.result > 1) {
+            std::cerr << path << ": record " << (&rec - in.begin()) << " has result " << int(rec.result)
+                      << ", not a packed position file\n";
+            return 1;
+        }
+        ++results[rec.result + 1];
+        absScore += std::abs(rec.score);
+    }
+    std::cout << path << ": " << in.size() << " positions, +" << results[2] << " =" << results[1]
+              << " -" << results[0] << ", mean |score| "
+              << (in.size() ? absScore / static_cast<long long>(in.size()) : 0) << "\n";
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--inspect" && i + 1 < argc)
+            return inspect(argv[i + 1]);
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << a << "\n";
+            return 1;
+        }
+        if (a == "-t") opt.threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-n") opt.positions = std::atoll(argv[++i]);
+        else if (a == "-d") opt.depth = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-o") opt.prefix = argv[++i];
+        else if (a == "-s") opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::cerr << "Unknown option " << a << "\n";
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < opt.threads; ++i) {
+        if (std::filesystem::exists(shardPath(opt, i))) {
+            std::cerr << shardPath(opt, i) << " already exists; remove it or choose another -o prefix\n";
+            return 1;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::path(opt.prefix).parent_path();
+    if (!dir.empty() && !std::filesystem::create_directories(dir, ec) && ec) {
+        std::cerr << "Failed to create " << dir.string() << ": " << ec.message() << "\n";
+        return 1;
+    }
+    // Open every shard up front so a bad path fails before any work starts
+    std::vector<std::unique_ptr<PackedWriter>> shards;
+    for (int i = 0; i < opt.threads; ++i) {
+        shards.push_back(std::make_unique<PackedWriter>(shardPath(opt, i)));
+        if (!shards.back()->isOpen())
+            return 1;
+    }
+
+    std::cout << "Generating " << opt.positions << " positions on " << opt.threads
+              << " threads (depth " << opt.depth << ")\n";
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    running = opt.threads;
+    for (int i = 0; i < opt.threads; ++i)
+        pool.emplace_back(worker, i, std::cref(opt), std::ref(*shards[i]));
+
+    auto elapsed = [&] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto report = [&](const char *label) {
+        double s = elapsed();
+        double rate = s > 0 ? produced / s : 0;
+        std::cout << label << produced << " positions, " << gamesPlayed << " games, " << s << " s, "
+                  << static_cast<long long>(rate) << " pos/s (" << rate * 3600 / 1e6 << " M/hour)\n";
+    };
+
+    long long lastReport = 0;
+    while (running > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (elapsed() >= lastReport + 5) {
+            lastReport = static_cast<long long>(elapsed());
+            report("  ");
+        }
+    }
+    for (auto &t : pool)
+        t.join();
+    report("Done: ");
+    return 0;
+}
@@ -1,8 +1,25 @@
 #include "game.hpp"
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
 #include <iostream>
+#include <thread>
+
+Game::Game(const GameOptions &opts)
+    : options(opts) {
+    if (options.offscreen) {
+        if (!offscreenTarget.create(WINDOW_WIDTH, WINDOW_HEIGHT))
+            std::cerr << "Failed to create offscreen render target\n";
+        canvas = &offscreenTarget;
+    } else {
+        mWindow.create({WINDOW_WIDTH, WINDOW_HEIGHT}, "Chess Game");
+        // Replays measure raw frame cost, so never wait for vsync
+        mWindow.setVerticalSyncEnabled(false);
+    }
+    if (!options.recordPath.empty())
+        recorder.open(options.recordPath);
+    if (!options.replayPath.empty() && !replay.load(options.replayPath))
+        quitRequested = true;
 
-Game::Game()
-    : mWindow({WINDOW_WIDTH, WINDOW_HEIGHT}, "Chess Game") {
     newGame();
     
     if (!font.loadFromFile("./assets/arial.ttf")) {
@@ -11,6 +28,11 @@ Game::Game()
     setupUI();
 }
 
+// The analysis future blocks in its destructor; stop the searches first
+Game::~Game() {
+    cancelAnalysis = true;
+}
+
 void Game::setupUI() {
     menuBar.setSize({static_cast<float>(WINDOW_WIDTH), static_cast<float>(MENU_BAR_HEIGHT)});
     menuBar.setPosition(0, 0);
@@ -68,31 +90,52 @@ void Game::setupUI() {
     exitText.setCharacterSize(20);
     exitText.setFillColor(sf::Color::White);
     exitText.setPosition(475, 75);
+
+    moveListPanel.setSize({static_cast<float>(MOVE_PANEL_WIDTH),
+                           static_cast<float>(WINDOW_HEIGHT - MENU_BAR_HEIGHT)});
+    moveListPanel.setPosition(BOARD_PIXELS, MENU_BAR_HEIGHT);
+    moveListPanel.setFillColor(sf::Color(30, 30, 30));
+
+    moveListCursor.setSize({80, static_cast<float>(MOVE_LIST_LINE_HEIGHT)});
+    moveListCursor.setFillColor(sf::Color(70, 130, 180));
+
+    moveListText.setFont(font);
+    moveListText.setCharacterSize(16);
+    moveListText.setFillColor(sf::Color::White);
+
+    sliderTrack.setSize({static_cast<float>(BOARD_PIXELS - 2 * SLIDER_MARGIN), 6});
+    sliderTrack.setPosition(SLIDER_MARGIN, SLIDER_Y);
+    sliderTrack.setFillColor(sf::Color(90, 90, 140));
+
+    sliderKnob.setSize({12, 22});
+    sliderKnob.setFillColor(sf::Color::White);
+
+    analyzeButton.setSize({180, 40});
+    analyzeButton.setPosition(BOARD_PIXELS + 20, 20);
+    analyzeButton.setFillColor(sf::Color(46, 139, 87));
+    analyzeButton.setOutlineColor(sf::Color::White);
+    analyzeButton.setOutlineThickness(2);
+
+    analyzeText.setFont(font);
+    analyzeText.setString("Analyze");
+    analyzeText.setCharacterSize(20);
+    analyzeText.setFillColor(sf::Color::White);
+    analyzeText.setPosition(BOARD_PIXELS + 40, 25);
+
+    evalGraphPanel.setSize({static_cast<float>(MOVE_PANEL_WIDTH), static_cast<float>(EVAL_GRAPH_HEIGHT)});
+    evalGraphPanel.setPosition(BOARD_PIXELS, WINDOW_HEIGHT - EVAL_GRAPH_HEIGHT);
+    evalGraphPanel.setFillColor(sf::Color(20, 20, 20));
+    evalGraphPanel.setOutlineColor(sf::Color(100, 100, 100));
+    evalGraphPanel.setOutlineThickness(1.f);
 }
 
 void Game::newGame() {
     gameState = GameState::Playing;
-    whiteToMove = true;
-    canCastleK[0] = canCastleK[1] = true;
-    canCastleQ[0] = canCastleQ[1] = true;
-    enPassantTarget = {-1, -1};
-    moveHistory.clear();
+    pos.reset();
+    timeline.reset(pos);
+    historyChanged();
     lastLegalMoves.clear();
-    isPieceSelected = isDragging = false;
-    
-    const char init[BOARD_SIZE][BOARD_SIZE] = {
-        {'r', 'n', 'b', 'q', 'k', 'b', 'n', 'r'},
-        {'p', 'p', 'p', 'p', 'p', 'p', 'p', 'p'},
-        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
-        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
-        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
-        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
-        {'P', 'P', 'P', 'P', 'P', 'P', 'P', 'P'},
-        {'R', 'N', 'B', 'Q', 'K', 'B', 'N', 'R'}};
-        
-    for (int y = 0; y < BOARD_SIZE; ++y)
-        for (int x = 0; x < BOARD_SIZE; ++x)
-            boardLogic[y][x] = init[y][x];
+    isPieceSelected = isDragging = isScrubbing = false;
 
     float px = 0, py = MENU_BAR_HEIGHT;
     for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; ++i) {
@@ -110,17 +153,64 @@ void Game::newGame() {
     }
 
     highlight.setSize({static_cast<float>(SQUARE_SIZE), static_cast<float>(SQUARE_SIZE)});
-    highlight.setFillColor({50, 200, 50, 100});
 
     loadTextures();
     initSprites();
 }
 
 void Game::run() {
-    while (mWindow.isOpen()) {
-        processEvent();
+    bool replaying = !options.replayPath.empty();
+    sf::Clock frameClock;
+    while (isRunning()) {
+        // In a replay all of a frame's input is injected at its start, so
+        // the frame time of an input frame is its input-to-present latency
+        // (present() waits for rendering to finish before the clock is read).
+        frameClock.restart();
+        int inputs = processEvent();
         update();
         render();
+        if (replaying)
+            frameStats.add(frameClock.getElapsedTime().asMicroseconds() / 1000.0, inputs);
+        ++frameIndex;
+    }
+
+    if (replaying) {
+        std::cout << "Replayed " << frameIndex << " frames from " << options.replayPath << "\n";
+        frameStats.report(std::cout);
+        if (!options.timingsPath.empty())
+            frameStats.writeCsv(options.timingsPath);
+    }
+}
+
+bool Game::isRunning() const {
+    if (quitRequested)
+        return false;
+    if (!options.replayPath.empty() && replay.finished(frameIndex))
+        return false;
+    return options.offscreen || mWindow.isOpen();
+}
+
+void Game::quit() {
+    quitRequested = true;
+    cancelAnalysis = true;
+    if (mWindow.isOpen())
+        mWindow.close();
+}
+
+void Game::present() {
+    if (options.offscreen)
+        offscreenTarget.display();
+    else
+        mWindow.display();
+
+    // display() only submits the frame, and software GL may rasterize it
+    // later. A replay waits for the GL work so its timings cover rendering.
+    if (!options.replayPath.empty()) {
+        if (options.offscreen)
+            offscreenTarget.setActive(true);
+        else
+            mWindow.setActive(true);
+        glFinish();
     }
 }
 
@@ -139,9 +229,9 @@ void Game::loadTextures() {
 void Game::initSprites() {
     for (int y = 0; y < BOARD_SIZE; ++y) {
         for (int x = 0; x < BOARD_SIZE; ++x) {
-            char p = boardLogic[y][x];
+            char p = pos.boardLogic[y][x];
             if (p == ' ') continue;
-            std::string code = isWhite(p) ? "w" : "b";
+            std::string code = pos.isWhite(p) ? "w" : "b";
             code += tolower(p);
             auto &spr = pieceSprites[y][x];
             spr.setTexture(pieceTextures[code]);
@@ -153,83 +243,152 @@ void Game::initSprites() {
     }
 }
 
-void Game::processEvent() {
+// Collects this frame's input, from the window or the replay file, and
+// returns how many events were handled.
+int Game::processEvent() {
+    frameEvents.clear();
     sf::Event ev;
-    while (mWindow.pollEvent(ev)) {
-        if (ev.type == sf::Event::Closed)
-            mWindow.close();
+    while (mWindow.isOpen() && mWindow.pollEvent(ev)) {
+        // During a replay the live window only gets a say in closing
+        if (options.replayPath.empty() || ev.type == sf::Event::Closed)
+            frameEvents.push_back(ev);
+    }
+    if (!options.replayPath.empty())
+        replay.eventsForFrame(frameIndex, frameEvents);
 
-        if (ev.type == sf::Event::MouseButtonPressed) {
-            sf::Vector2i mousePos = sf::Mouse::getPosition(mWindow);
-            
-            if (newGameButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
-                newGame();
-                return;
-            }
-            
-            if (undoButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
-                undoMove();
-                return;
-            }
-            
-            if (exitButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
-                mWindow.close();
-                return;
-            }
-            
-            if (gameState == GameState::Menu && 
-                newGameButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
-                newGame();
-                return;
-            }
+    for (auto &e : frameEvents) {
+        if (recorder.isOpen())
+            recorder.record(frameIndex, e);
+        handleEvent(e);
+    }
+    return static_cast<int>(frameEvents.size());
+}
+
+void Game::handleEvent(const sf::Event &ev) {
+    if (ev.type == sf::Event::Closed)
+        quit();
+
+    if (ev.type == sf::Event::MouseMoved)
+        mousePos = {ev.mouseMove.x, ev.mouseMove.y};
+    if (ev.type == sf::Event::MouseButtonPressed || ev.type == sf::Event::MouseButtonReleased)
+        mousePos = {ev.mouseButton.x, ev.mouseButton.y};
+
+    if (ev.type == sf::Event::MouseButtonPressed) {
+        if (newGameButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
+            newGame();
+            return;
+        }
+        
+        if (undoButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
+            undoMove();
+            return;
+        }
+        
+        if (exitButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
+            quit();
+            return;
+        }
+        
+        if (gameState == GameState::Menu && 
+            newGameButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
+            newGame();
+            return;
         }
 
-        if (gameState == GameState::Playing) {
-            if (ev.type == sf::Event::MouseButtonPressed && 
-                ev.mouseButton.button == sf::Mouse::Left) {
-                int x = ev.mouseButton.x / SQUARE_SIZE,
-                    y = (ev.mouseButton.y - MENU_BAR_HEIGHT) / SQUARE_SIZE;
-                    
-                if (y >= 0 && y < BOARD_SIZE) {
-                    char p = boardLogic[y][x];
-                    if (p != ' ' && ((whiteToMove && isWhite(p)) || (!whiteToMove && isBlack(p)))) {
-                        selectedSquare = {x, y};
-                        isPieceSelected = isDragging = true;
-                        std::string code = (isWhite(p) ? "w" : "b") + std::string(1, tolower(p));
-                        draggedSprite.setTexture(pieceTextures[code]);
-                        auto &tx = pieceTextures[code];
-                        draggedSprite.setScale(static_cast<float>(SQUARE_SIZE) / tx.getSize().x, 
-                                              static_cast<float>(SQUARE_SIZE) / tx.getSize().y);
-                    }
-                    lastLegalMoves.clear();
-                    for (auto &mv : legalMoves()) {
-                        if (mv[0] == x && mv[1] == y)
-                            lastLegalMoves.insert(mv);
-                    }
-                }
-            }
+        if (gameState != GameState::Menu && mousePos.y >= SLIDER_Y - 15 && mousePos.y <= SLIDER_Y + 20 &&
+            mousePos.x >= SLIDER_MARGIN - 10 && mousePos.x <= BOARD_PIXELS - SLIDER_MARGIN + 10) {
+            isScrubbing = true;
+            jumpToPly(sliderPlyAt(mousePos.x));
+            return;
+        }
+
+        if (gameState != GameState::Menu &&
+            analyzeButton.getGlobalBounds().contains(mousePos.x, mousePos.y)) {
+            startAnalysis();
+            return;
+        }
+
+        if (gameState != GameState::Menu && analysis.complete && mousePos.x >= BOARD_PIXELS &&
+            mousePos.y >= WINDOW_HEIGHT - EVAL_GRAPH_HEIGHT) {
+            float t = static_cast<float>(mousePos.x - BOARD_PIXELS) / MOVE_PANEL_WIDTH;
+            jumpToPly(static_cast<int>(t * timeline.size() + 0.5f));
+            return;
+        }
+
+        if (gameState != GameState::Menu && mousePos.x >= BOARD_PIXELS &&
+            mousePos.y >= MENU_BAR_HEIGHT + MOVE_LIST_HEADER) {
+            int line = moveListFirstLine + (mousePos.y - MENU_BAR_HEIGHT - MOVE_LIST_HEADER) / MOVE_LIST_LINE_HEIGHT;
+            int idx = line * 2 + (mousePos.x >= BOARD_PIXELS + 130 ? 1 : 0);
+            if (idx < timeline.size())
+                jumpToPly(idx + 1);
+            return;
+        }
+    }
+
+    if (ev.type == sf::Event::MouseMoved && isScrubbing)
+        jumpToPly(sliderPlyAt(ev.mouseMove.x));
+
+    if (ev.type == sf::Event::MouseButtonReleased && isScrubbing) {
+        isScrubbing = false;
+        return;
+    }
 
-            if (ev.type == sf::Event::MouseButtonReleased && 
-                ev.mouseButton.button == sf::Mouse::Left && 
-                isPieceSelected) {
-                int x = sf::Mouse::getPosition(mWindow).x / SQUARE_SIZE,
-                    y = (sf::Mouse::getPosition(mWindow).y - MENU_BAR_HEIGHT) / SQUARE_SIZE;
-                    
-                if (y >= 0 && y < BOARD_SIZE) {
-                    if (x != selectedSquare.x || y != selectedSquare.y)
-                        handleMoves(selectedSquare.x, selectedSquare.y, x, y);
+    if (ev.type == sf::Event::KeyPressed && gameState != GameState::Menu) {
+        switch (ev.key.code) {
+            case sf::Keyboard::Left:  jumpToPly(timeline.ply() - 1); break;
+            case sf::Keyboard::Right: jumpToPly(timeline.ply() + 1); break;
+            case sf::Keyboard::Home:  jumpToPly(0); break;
+            case sf::Keyboard::End:   jumpToPly(timeline.size()); break;
+            default: break;
+        }
+    }
+
+    if (gameState == GameState::Playing) {
+        if (ev.type == sf::Event::MouseButtonPressed && 
+            ev.mouseButton.button == sf::Mouse::Left) {
+            int x = ev.mouseButton.x / SQUARE_SIZE,
+                y = (ev.mouseButton.y - MENU_BAR_HEIGHT) / SQUARE_SIZE;
+                
+            if (y >= 0 && y < BOARD_SIZE && x < BOARD_SIZE) {
+                char p = pos.boardLogic[y][x];
+                if (p != ' ' && ((pos.whiteToMove && pos.isWhite(p)) || (!pos.whiteToMove && pos.isBlack(p)))) {
+                    selectedSquare = {x, y};
+                    isPieceSelected = isDragging = true;
+                    std::string code = (pos.isWhite(p) ? "w" : "b") + std::string(1, tolower(p));
+                    draggedSprite.setTexture(pieceTextures[code]);
+                    auto &tx = pieceTextures[code];
+                    draggedSprite.setScale(static_cast<float>(SQUARE_SIZE) / tx.getSize().x, 
+                                          static_cast<float>(SQUARE_SIZE) / tx.getSize().y);
                 }
-                isPieceSelected = isDragging = false;
                 lastLegalMoves.clear();
+                for (auto &mv : pos.legalMoves()) {
+                    if (mv[0] == x && mv[1] == y)
+                        lastLegalMoves.insert(mv);
+                }
+            }
+        }
+
+        if (ev.type == sf::Event::MouseButtonReleased && 
+            ev.mouseButton.button == sf::Mouse::Left && 
+            isPieceSelected) {
+            int x = ev.mouseButton.x / SQUARE_SIZE,
+                y = (ev.mouseButton.y - MENU_BAR_HEIGHT) / SQUARE_SIZE;
+                
+            if (y >= 0 && y < BOARD_SIZE && x < BOARD_SIZE) {
+                if (x != selectedSquare.x || y != selectedSquare.y)
+                    handleMoves(selectedSquare.x, selectedSquare.y, x, y);
             }
+            isPieceSelected = isDragging = false;
+            lastLegalMoves.clear();
         }
     }
 }
 
 void Game::update() {
+    pollAnalysis();
     if (gameState == GameState::Playing) {
-        std::string status = whiteToMove ? "White's turn" : "Black's turn";
-        if (inCheck(whiteToMove)) {
+        std::string status = pos.whiteToMove ? "White's turn" : "Black's turn";
+        if (pos.inCheck(pos.whiteToMove)) {
             status += " (CHECK!)";
         }
         statusText.setString(status);
@@ -240,11 +399,11 @@ void Game::update() {
 }
 
 void Game::checkGameState() {
-    auto moves = legalMoves();
+    auto moves = pos.legalMoves();
     if (moves.empty()) {
         gameState = GameState::GameOver;
-        if (inCheck(whiteToMove)) {
-            gameOverText.setString(whiteToMove ? "Black Wins!\nCheckmate" : "White Wins!\nCheckmate");
+        if (pos.inCheck(pos.whiteToMove)) {
+            gameOverText.setString(pos.whiteToMove ? "Black Wins!\nCheckmate" : "White Wins!\nCheckmate");
         } else {
             gameOverText.setString("Stalemate!\nDraw Game");
         }
@@ -252,35 +411,42 @@ void Game::checkGameState() {
 }
 
 void Game::render() {
-    mWindow.clear(sf::Color(40, 40, 40));
+    canvas->clear(sf::Color(40, 40, 40));
     
-    mWindow.draw(menuBar);
-    mWindow.draw(titleText);
-    mWindow.draw(statusText);
+    canvas->draw(menuBar);
+    canvas->draw(titleText);
+    canvas->draw(statusText);
     
     if (gameState == GameState::Menu) {
         newGameButton.setSize({200, 80});
         newGameButton.setPosition(300, 350);
         newGameButton.setFillColor(sf::Color(70, 130, 180));
-        mWindow.draw(newGameButton);
+        canvas->draw(newGameButton);
         
         newGameText.setString("Play Chess");
         newGameText.setCharacterSize(36);
         newGameText.setPosition(325, 365);
-        mWindow.draw(newGameText);
+        canvas->draw(newGameText);
         
         sf::Text menuTitle = titleText;
         menuTitle.setCharacterSize(72);
         menuTitle.setPosition(200, 200);
-        mWindow.draw(menuTitle);
+        canvas->draw(menuTitle);
     }
     else {
         for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; ++i)
-            mWindow.draw(board[i]);
+            canvas->draw(board[i]);
 
+        // Targets are shaded by static exchange: red loses material, gold wins it
         for (auto &mv : lastLegalMoves) {
+            GenMove gm{static_cast<uint8_t>(mv[1] * BOARD_SIZE + mv[0]),
+                       static_cast<uint8_t>(mv[3] * BOARD_SIZE + mv[2])};
+            int gain = pos.see(gm);
+            highlight.setFillColor(gain < 0   ? sf::Color(220, 50, 50, 110)
+                                   : gain > 0 ? sf::Color(240, 200, 40, 120)
+                                              : sf::Color(50, 200, 50, 100));
             highlight.setPosition(mv[2] * SQUARE_SIZE, mv[3] * SQUARE_SIZE + MENU_BAR_HEIGHT);
-            mWindow.draw(highlight);
+            canvas->draw(highlight);
         }
 
         initSprites();
@@ -288,391 +454,228 @@ void Game::render() {
             for (int x = 0; x < BOARD_SIZE; ++x) {
                 if (isDragging && x == selectedSquare.x && y == selectedSquare.y)
                     continue;
-                if (boardLogic[y][x] != ' ')
-                    mWindow.draw(pieceSprites[y][x]);
+                if (pos.boardLogic[y][x] != ' ')
+                    canvas->draw(pieceSprites[y][x]);
             }
         }
 
         if (isDragging) {
-            auto mp = sf::Mouse::getPosition(mWindow);
-            draggedSprite.setPosition(mp.x - 50, mp.y - 50);
-            mWindow.draw(draggedSprite);
+            draggedSprite.setPosition(mousePos.x - 50, mousePos.y - 50);
+            canvas->draw(draggedSprite);
         }
         
         if (gameState == GameState::GameOver) {
-            sf::RectangleShape overlay({static_cast<float>(WINDOW_WIDTH), 
+            sf::RectangleShape overlay({static_cast<float>(BOARD_PIXELS), 
                                        static_cast<float>(WINDOW_HEIGHT - MENU_BAR_HEIGHT)});
             overlay.setPosition(0, MENU_BAR_HEIGHT);
             overlay.setFillColor(sf::Color(0, 0, 0, 180));
-            mWindow.draw(overlay);
-            mWindow.draw(gameOverText);
+            canvas->draw(overlay);
+            canvas->draw(gameOverText);
             
             newGameButton.setSize({200, 60});
             newGameButton.setPosition(300, 500);
             newGameButton.setFillColor(sf::Color(70, 130, 180));
-            mWindow.draw(newGameButton);
+            canvas->draw(newGameButton);
             
             newGameText.setString("Click On New Game");
             newGameText.setCharacterSize(15);
             newGameText.setPosition(335, 515);
-            mWindow.draw(newGameText);
+            canvas->draw(newGameText);
         }
         
         newGameButton.setSize({150, 40});
         newGameButton.setPosition(600, 20);
-        mWindow.draw(newGameButton);
-        mWindow.draw(undoButton);
-        mWindow.draw(exitButton);
+        canvas->draw(newGameButton);
+        canvas->draw(undoButton);
+        canvas->draw(exitButton);
         
         newGameText.setString("New Game");
         newGameText.setCharacterSize(20);
         newGameText.setPosition(610, 25);
-        mWindow.draw(newGameText);
-        mWindow.draw(undoText);
-        mWindow.draw(exitText);
+        canvas->draw(newGameText);
+        canvas->draw(undoText);
+        canvas->draw(exitText);
+
+        canvas->draw(sliderTrack);
+        int total = std::max(1, timeline.size());
+        float trackW = BOARD_PIXELS - 2 * SLIDER_MARGIN;
+        sliderKnob.setPosition(SLIDER_MARGIN + trackW * timeline.ply() / total - 6, SLIDER_Y - 8);
+        canvas->draw(sliderKnob);
+
+        canvas->draw(analyzeButton);
+        canvas->draw(analyzeText);
+        drawMoveList();
+        drawEvalGraph();
     }
     
-    mWindow.display();
+    present();
 }
 
-std::set<std::vector<int>> Game::pseudoLegalMoves(bool w) const {
-    std::set<std::vector<int>> M;
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            char p = boardLogic[y][x];
-            if (p == ' ' || (w != isWhite(p)))
-                continue;
-
-            int dir = isWhite(p) ? -1 : 1;
-
-            switch (tolower(p)) {
-                case 'p': {
-                    int ny = y + dir;
-                    if (inBounds(x, ny) && isEmpty(x, ny))
-                        M.insert({x, y, x, ny});
-                    if (((isWhite(p) && y == WHITE_PAWN_START_ROW) || 
-                         (isBlack(p) && y == BLACK_PAWN_START_ROW))) {
-                        int ny2 = y + 2 * dir;
-                        if (inBounds(x, ny2) && isEmpty(x, ny) && isEmpty(x, ny2))
-                            M.insert({x, y, x, ny2});
-                    }
-                    if (isOpponent(x - 1, ny, w))
-                        M.insert({x, y, x - 1, ny});
-                    if (isOpponent(x + 1, ny, w))
-                        M.insert({x, y, x + 1, ny});
-                    int ex = enPassantTarget.first, ey = enPassantTarget.second;
-                    if (inBounds(ex, ey) && ey == y + dir && abs(ex - x) == 1 && boardLogic[y][ex] != ' ') {
-                        M.insert({x, y, ex, ey});
-                    }
-                    break;
-                }
-                case 'n': {
-                    const int DX[8] = {1, 2, 2, 1, -1, -2, -2, -1};
-                    const int DY[8] = {-2, -1, 1, 2, 2, 1, -1, -2};
-                    for (int i = 0; i < 8; ++i) {
-                        int nx = x + DX[i], ny = y + DY[i];
-                        if (inBounds(nx, ny) && !sameColor(p, boardLogic[ny][nx]))
-                            M.insert({x, y, nx, ny});
-                    }
-                    break;
-                }
-                case 'b': {
-                    for (int dx : {-1, 1}) {
-                        for (int dy : {-1, 1}) {
-                            for (int i = 1; i < BOARD_SIZE; ++i) {
-                                int nx = x + dx * i, ny = y + dy * i;
-                                if (!inBounds(nx, ny)) break;
-                                if (boardLogic[ny][nx] == ' ') {
-                                    M.insert({x, y, nx, ny});
-                                } else {
-                                    if (isOpponent(nx, ny, w))
-                                        M.insert({x, y, nx, ny});
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                    break;
-                }
-                case 'r': {
-                    for (int d : {-1, 1}) {
-                        for (int i = 1; i < BOARD_SIZE; ++i) {
-                            int nx = x + d * i;
-                            if (!inBounds(nx, y)) break;
-                            if (boardLogic[y][nx] == ' ') {
-                                M.insert({x, y, nx, y});
-                            } else {
-                                if (isOpponent(nx, y, w))
-                                    M.insert({x, y, nx, y});
-                                break;
-                            }
-                        }
-                        for (int i = 1; i < BOARD_SIZE; ++i) {
-                            int ny = y + d * i;
-                            if (!inBounds(x, ny)) break;
-                            if (boardLogic[ny][x] == ' ') {
-                                M.insert({x, y, x, ny});
-                            } else {
-                                if (isOpponent(x, ny, w))
-                                    M.insert({x, y, x, ny});
-                                break;
-                            }
-                        }
-                    }
-                    break;
-                }
-                case 'q': {
-                    for (int dx : {-1, 1}) {
-                        for (int dy : {-1, 1}) {
-                            for (int i = 1; i < BOARD_SIZE; ++i) {
-                                int nx = x + dx * i, ny = y + dy * i;
-                                if (!inBounds(nx, ny)) break;
-                                if (boardLogic[ny][nx] == ' ') {
-                                    M.insert({x, y, nx, ny});
-                                } else {
-                                    if (isOpponent(nx, ny, w))
-                                        M.insert({x, y, nx, ny});
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                    for (int d : {-1, 1}) {
-                        for (int i = 1; i < BOARD_SIZE; ++i) {
-                            int nx = x + d * i;
-                            if (!inBounds(nx, y)) break;
-                            if (boardLogic[y][nx] == ' ') {
-                                M.insert({x, y, nx, y});
-                            } else {
-                                if (isOpponent(nx, y, w))
-                                    M.insert({x, y, nx, y});
-                                break;
-                            }
-                        }
-                        for (int i = 1; i < BOARD_SIZE; ++i) {
-                            int ny = y + d * i;
-                            if (!inBounds(x, ny)) break;
-                            if (boardLogic[ny][x] == ' ') {
-                                M.insert({x, y, x, ny});
-                            } else {
-                                if (isOpponent(x, ny, w))
-                                    M.insert({x, y, x, ny});
-                                break;
-                            }
-                        }
-                    }
-                    break;
-                }
-                case 'k': {
-                    for (int dx = -1; dx <= 1; ++dx) {
-                        for (int dy = -1; dy <= 1; ++dy) {
-                            if (dx == 0 && dy == 0) continue;
-                            int nx = x + dx, ny = y + dy;
-                            if (inBounds(nx, ny) && !sameColor(p, boardLogic[ny][nx]))
-                                M.insert({x, y, nx, ny});
-                        }
-                    }
-                    int row = w ? WHITE_BACK_ROW : BLACK_BACK_ROW;
-                    if (canCastleK[w] && boardLogic[row][5] == ' ' && boardLogic[row][6] == ' ') {
-                        M.insert({4, row, 6, row});
-                    }
-                    if (canCastleQ[w] && boardLogic[row][3] == ' ' && boardLogic[row][2] == ' ' && boardLogic[row][1] == ' ') {
-                        M.insert({4, row, 2, row});
-                    }
-                    break;
-                }
-            }
-        }
-    }
-    return M;
+void Game::handleMoves(int x1, int y1, int x2, int y2) {
+    char pc = pos.boardLogic[y1][x1], tgt = pos.boardLogic[y2][x2];
+    if (pc == ' ' || pos.sameColor(pc, tgt))
+        return;
+    auto LM = pos.legalMoves();
+    if (!LM.count({x1, y1, x2, y2}))
+        return;
+
+    // Moving from an earlier ply starts a new line; the old continuation is dropped.
+    timeline.play(pos, x1, y1, x2, y2);
+    historyChanged();
+    checkGameState();
 }
 
-std::set<std::vector<int>> Game::legalMoves() {
-    auto P = pseudoLegalMoves(whiteToMove);
-    std::set<std::vector<int>> L;
-    for (auto &mv : P) {
-        int x1 = mv[0], y1 = mv[1], x2 = mv[2], y2 = mv[3];
-        char pc = boardLogic[y1][x1], cap = boardLogic[y2][x2];
-        bool isKingMove = (tolower(pc) == 'k');
-        bool isCastling = (isKingMove && abs(x2 - x1) == 2);
-
-        if (isCastling) {
-            if (inCheck(whiteToMove))
-                continue;
-            int passX = (x1 + x2) / 2;
-            if (isSquareAttacked(passX, y1, !whiteToMove))
-                continue;
-            if (isSquareAttacked(x2, y2, !whiteToMove))
-                continue;
-        }
+void Game::undoMove() {
+    if (!timeline.undo(pos))
+        return;
 
-        boardLogic[y2][x2] = pc;
-        boardLogic[y1][x1] = ' ';
-        bool ep = (tolower(pc) == 'p' && x2 != x1 && cap == ' ');
-        char epCap = ' ';
-        if (ep) {
-            epCap = boardLogic[y1][x2];
-            boardLogic[y1][x2] = ' ';
-        }
+    historyChanged();
+    isPieceSelected = isDragging = false;
+    lastLegalMoves.clear();
+    gameState = GameState::Playing;
+    gameOverText.setString("");
+}
 
-        bool safe = !inCheck(whiteToMove);
-        boardLogic[y1][x1] = pc;
-        boardLogic[y2][x2] = cap;
-        if (ep)
-            boardLogic[y1][x2] = epCap;
+void Game::jumpToPly(int ply) {
+    ply = std::clamp(ply, 0, timeline.size());
+    if (ply == timeline.ply())
+        return;
+    timeline.jumpTo(pos, ply);
 
-        if (safe)
-            L.insert(mv);
-    }
-    return L;
+    isPieceSelected = isDragging = false;
+    lastLegalMoves.clear();
+    gameState = GameState::Playing;
+    gameOverText.setString("");
+    // Only the final position of a line can be checkmate or stalemate
+    if (ply == timeline.size())
+        checkGameState();
 }
 
-bool Game::inCheck(bool white) const {
-    int kx = -1, ky = -1;
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            if (boardLogic[y][x] == (white ? 'K' : 'k')) {
-                kx = x;
-                ky = y;
-            }
-        }
-    }
-    if (kx == -1) return false;
-    return isSquareAttacked(kx, ky, !white);
+int Game::sliderPlyAt(int x) const {
+    float trackW = BOARD_PIXELS - 2 * SLIDER_MARGIN;
+    float t = std::clamp((x - SLIDER_MARGIN) / trackW, 0.f, 1.f);
+    return static_cast<int>(t * timeline.size() + 0.5f);
 }
 
-bool Game::isSquareAttacked(int x, int y, bool byWhite) const {
-    auto oppMoves = pseudoLegalMoves(byWhite);
-    for (auto &mv : oppMoves) {
-        if (mv[2] == x && mv[3] == y)
-            return true;
-    }
-    return false;
+std::string Game::moveText(const Move &m) const {
+    if (m.wasCastling)
+        return m.x2 > m.x1 ? "O-O" : "O-O-O";
+    auto sq = [](int x, int y) {
+        return std::string{static_cast<char>('a' + x), static_cast<char>('0' + BOARD_SIZE - y)};
+    };
+    std::string s = sq(m.x1, m.y1) + (m.captured != ' ' ? "x" : "-") + sq(m.x2, m.y2);
+    if (m.wasPromotion)
+        s += "=Q";
+    return s;
 }
 
-void Game::handleMoves(int x1, int y1, int x2, int y2) {
-    char pc = boardLogic[y1][x1], tgt = boardLogic[y2][x2];
-    if (pc == ' ' || sameColor(pc, tgt))
-        return;
-    auto LM = legalMoves();
-    if (!LM.count({x1, y1, x2, y2}))
-        return;
-
-    Move m;
-    m.oldCastleK[0] = canCastleK[0];
-    m.oldCastleK[1] = canCastleK[1];
-    m.oldCastleQ[0] = canCastleQ[0];
-    m.oldCastleQ[1] = canCastleQ[1];
-    m.oldEnPassant = enPassantTarget;
-
-    m.x1 = x1;
-    m.y1 = y1;
-    m.x2 = x2;
-    m.y2 = y2;
-    m.moved = pc;
-    m.captured = tgt;
-
-    m.wasEnPassant = (tolower(pc) == 'p' && x1 != x2 && tgt == ' ');
-    if (m.wasEnPassant) {
-        m.captured = boardLogic[y1][x2];
-        boardLogic[y1][x2] = ' ';
-    }
-
-    if (tolower(m.captured) == 'r') {
-        int ry = whiteToMove ? BLACK_BACK_ROW : WHITE_BACK_ROW;
-        int capY = m.wasEnPassant ? y1 : y2;
-        if (capY == ry) {
-            if (x2 == 0) {
-                canCastleQ[!whiteToMove] = false;
-            } else if (x2 == 7) {
-                canCastleK[!whiteToMove] = false;
+void Game::drawMoveList() {
+    canvas->draw(moveListPanel);
+
+    int total = timeline.size();
+    moveListText.setString("Moves  " + std::to_string(timeline.ply()) + "/" + std::to_string(total));
+    moveListText.setPosition(BOARD_PIXELS + 10, MENU_BAR_HEIGHT + 10);
+    canvas->draw(moveListText);
+
+    // Scroll so the current move stays in view
+    int lines = (total + 1) / 2;
+    int visible = (WINDOW_HEIGHT - MENU_BAR_HEIGHT - MOVE_LIST_HEADER - EVAL_GRAPH_HEIGHT) / MOVE_LIST_LINE_HEIGHT;
+    int curLine = std::max(0, timeline.ply() - 1) / 2;
+    moveListFirstLine = std::clamp(curLine - visible / 2, 0, std::max(0, lines - visible));
+
+    for (int line = moveListFirstLine; line < std::min(lines, moveListFirstLine + visible); ++line) {
+        float y = MENU_BAR_HEIGHT + MOVE_LIST_HEADER + (line - moveListFirstLine) * MOVE_LIST_LINE_HEIGHT;
+        moveListText.setString(std::to_string(line + 1) + ".");
+        moveListText.setPosition(BOARD_PIXELS + 10, y);
+        canvas->draw(moveListText);
+
+        for (int col = 0; col < 2; ++col) {
+            int idx = line * 2 + col;
+            if (idx >= total) break;
+            float x = BOARD_PIXELS + 50 + col * 80;
+            if (idx == timeline.ply() - 1) {
+                moveListCursor.setPosition(x - 4, y);
+                canvas->draw(moveListCursor);
             }
+            std::string text = moveText(timeline.history()[idx]);
+            Annotation mark = analysis.complete ? analysis.plies[idx].mark : Annotation::None;
+            text += annotationSymbol(mark);
+            moveListText.setString(text);
+            moveListText.setPosition(x, y);
+            moveListText.setFillColor(mark == Annotation::Blunder    ? sf::Color(255, 80, 80)
+                                    : mark == Annotation::Mistake    ? sf::Color(255, 160, 60)
+                                    : mark == Annotation::Inaccuracy ? sf::Color(240, 220, 90)
+                                                                     : sf::Color::White);
+            canvas->draw(moveListText);
+            moveListText.setFillColor(sf::Color::White);
         }
     }
+}
 
-    if (tolower(pc) == 'k') {
-        canCastleK[whiteToMove] = canCastleQ[whiteToMove] = false;
-        if (abs(x2 - x1) == 2) {
-            m.wasCastling = true;
-            int ry = whiteToMove ? WHITE_BACK_ROW : BLACK_BACK_ROW;
-            if (x2 > x1) {
-                m.rookX1 = 7;
-                m.rookY1 = ry;
-                m.rookX2 = x2 - 1;
-                m.rookY2 = ry;
-            } else {
-                m.rookX1 = 0;
-                m.rookY1 = ry;
-                m.rookX2 = x2 + 1;
-                m.rookY2 = ry;
-            }
-            char r = boardLogic[m.rookY1][m.rookX1];
-            boardLogic[m.rookY1][m.rookX1] = ' ';
-            boardLogic[m.rookY2][m.rookX2] = r;
-        }
-    }
-
-    if (tolower(pc) == 'r') {
-        int ry = whiteToMove ? WHITE_BACK_ROW : BLACK_BACK_ROW;
-        if (y1 == ry) {
-            if (x1 == 0) canCastleQ[whiteToMove] = false;
-            if (x1 == 7) canCastleK[whiteToMove] = false;
-        }
-    }
-
-    boardLogic[y2][x2] = pc;
-    boardLogic[y1][x1] = ' ';
-
-    m.wasPromotion = false;
-    if (tolower(pc) == 'p' && (y2 == BLACK_BACK_ROW || y2 == WHITE_BACK_ROW)) {
-        m.wasPromotion = true;
-        boardLogic[y2][x2] = whiteToMove ? 'Q' : 'q';
-    }
-
-    int dir = isWhite(pc) ? -1 : +1;
-    if (tolower(pc) == 'p' && abs(y2 - y1) == 2) {
-        enPassantTarget = {x2, y1 + dir};
-    } else {
-        enPassantTarget = {-1, -1};
-    }
-
-    moveHistory.push_back(m);
-    whiteToMove = !whiteToMove;
-    checkGameState();
+void Game::historyChanged() {
+    ++historyVersion;
+    analysis = GameAnalysis{};
+    // A running analysis would be discarded anyway (this covers newGame)
+    cancelAnalysis = true;
 }
 
-void Game::undoMove() {
-    if (moveHistory.empty())
+void Game::startAnalysis() {
+    if (pendingAnalysis.valid() || timeline.history().empty())
         return;
+    analysisVersion = historyVersion;
+    cancelAnalysis = false;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    pendingAnalysis = std::async(std::launch::async, analyzeGame, timeline.start(), timeline.history(),
+                                 threads, ANALYSIS_BUDGET_MS, &cancelAnalysis);
+    analyzeText.setString("Analyzing...");
+}
 
-    Move m = moveHistory.back();
-    moveHistory.pop_back();
-    whiteToMove = !whiteToMove;
-    gameState = GameState::Playing;
-    gameOverText.setString("");
-
-    if (m.wasEnPassant) {
-        boardLogic[m.y1][m.x1] = m.moved;
-        boardLogic[m.y2][m.x2] = ' ';
-        boardLogic[m.y1][m.x2] = m.captured;
-    } else {
-        boardLogic[m.y1][m.x1] = m.moved;
-        boardLogic[m.y2][m.x2] = m.captured;
-    }
-
-    if (m.wasCastling) {
-        char r = boardLogic[m.rookY2][m.rookX2];
-        boardLogic[m.rookY2][m.rookX2] = ' ';
-        boardLogic[m.rookY1][m.rookX1] = r;
-    }
+void Game::pollAnalysis() {
+    if (!pendingAnalysis.valid() ||
+        pendingAnalysis.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+    GameAnalysis result = pendingAnalysis.get();
+    analyzeText.setString("Analyze");
+    // Discard results for a game that changed while the analysis ran
+    if (analysisVersion != historyVersion || !result.complete)
+        return;
+    analysis = std::move(result);
+    if (exportPgn(analysis, "analysis.pgn"))
+        std::cout << "Annotated game written to analysis.pgn\n";
+}
 
-    if (m.wasPromotion) {
-        boardLogic[m.y1][m.x1] = (whiteToMove ? 'P' : 'p');
+void Game::drawEvalGraph() {
+    if (!analysis.complete)
+        return;
+    canvas->draw(evalGraphPanel);
+
+    float top = WINDOW_HEIGHT - EVAL_GRAPH_HEIGHT, mid = top + EVAL_GRAPH_HEIGHT / 2.f;
+    float step = static_cast<float>(MOVE_PANEL_WIDTH) / std::max<size_t>(1, analysis.evals.size() - 1);
+    auto yOf = [&](int cp) {
+        return mid - std::clamp(cp, -EVAL_GRAPH_RANGE, EVAL_GRAPH_RANGE) * (EVAL_GRAPH_HEIGHT / 2.f) / EVAL_GRAPH_RANGE;
+    };
+
+    sf::VertexArray axis(sf::Lines);
+    axis.append(sf::Vertex({static_cast<float>(BOARD_PIXELS), mid}, sf::Color(100, 100, 100)));
+    axis.append(sf::Vertex({static_cast<float>(WINDOW_WIDTH), mid}, sf::Color(100, 100, 100)));
+    float cx = BOARD_PIXELS + timeline.ply() * step;
+    axis.append(sf::Vertex({cx, top}, sf::Color(70, 130, 180)));
+    axis.append(sf::Vertex({cx, static_cast<float>(WINDOW_HEIGHT)}, sf::Color(70, 130, 180)));
+    canvas->draw(axis);
+
+    sf::VertexArray curve(sf::LineStrip);
+    for (size_t i = 0; i < analysis.evals.size(); ++i)
+        curve.append(sf::Vertex({BOARD_PIXELS + i * step, yOf(analysis.evals[i])}, sf::Color::White));
+    canvas->draw(curve);
+
+    // Mark annotated moves on the curve at the position they led to
+    sf::RectangleShape dot({5, 5});
+    for (size_t i = 0; i < analysis.plies.size(); ++i) {
+        Annotation mark = analysis.plies[i].mark;
+        if (mark == Annotation::None || mark == Annotation::Inaccuracy)
+            continue;
+        dot.setFillColor(mark == Annotation::Blunder ? sf::Color(255, 80, 80) : sf::Color(255, 160, 60));
+        dot.setPosition(BOARD_PIXELS + (i + 1) * step - 2.5f, yOf(analysis.evals[i + 1]) - 2.5f);
+        canvas->draw(dot);
     }
-
-    canCastleK[0] = m.oldCastleK[0];
-    canCastleK[1] = m.oldCastleK[1];
-    canCastleQ[0] = m.oldCastleQ[0];
-    canCastleQ[1] = m.oldCastleQ[1];
-    enPassantTarget = m.oldEnPassant;
-}
\ No newline at end of file
+}
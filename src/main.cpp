@@ -1,7 +1,30 @@
 #include "../include/game.hpp"
+#include <iostream>
 
-int main() {
-    Game g;
+int main(int argc, char **argv) {
+    GameOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--offscreen") {
+            opts.offscreen = true;
+        } else if (i + 1 < argc && a == "--record") {
+            opts.recordPath = argv[++i];
+        } else if (i + 1 < argc && a == "--replay") {
+            opts.replayPath = argv[++i];
+        } else if (i + 1 < argc && a == "--timings") {
+            opts.timingsPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--record file] [--replay file [--offscreen] [--timings file.csv]]\n";
+            return 1;
+        }
+    }
+    if (opts.offscreen && opts.replayPath.empty()) {
+        std::cerr << "--offscreen needs --replay\n";
+        return 1;
+    }
+
+    Game g(opts);
     g.run();
     return 0;
-}
\ No newline at end of file
+}
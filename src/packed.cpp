@@ -0,0 +1,100 @@
+#include "packed.hpp"
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PIECE_CODES[] = " PNBRQK  pnbrqk";
+
+static uint8_t pieceCode(char p) {
+    const char *c = strchr(PIECE_CODES + 1, p);
+    return c && p != ' ' ? static_cast<uint8_t>(c - PIECE_CODES) : 0;
+}
+
+PackedPosition pack(const Position &pos, int score, int result) {
+    PackedPosition rec{};
+    for (int sq = 0; sq < BOARD_SIZE * BOARD_SIZE; ++sq) {
+        uint8_t code = pieceCode(pos.boardLogic[sq / BOARD_SIZE][sq % BOARD_SIZE]);
+        rec.board[sq / 2] |= (sq % 2) ? code << 4 : code;
+    }
+    rec.flags = (pos.whiteToMove ? 1 : 0) | (pos.canCastleK[1] << 1) | (pos.canCastleQ[1] << 2) |
+                (pos.canCastleK[0] << 3) | (pos.canCastleQ[0] << 4);
+    auto [ex, ey] = pos.enPassantTarget;
+    rec.enPassant = pos.inBounds(ex, ey) ? ey * BOARD_SIZE + ex : NO_SQUARE;
+    rec.score = static_cast<int16_t>(score);
+    rec.result = static_cast<int8_t>(result);
+    return rec;
+}
+
+void unpack(const PackedPosition &rec, Position &pos) {
+    for (int sq = 0; sq < BOARD_SIZE * BOARD_SIZE; ++sq) {
+        uint8_t code = (rec.board[sq / 2] >> ((sq % 2) * 4)) & 0xF;
+        pos.boardLogic[sq / BOARD_SIZE][sq % BOARD_SIZE] = PIECE_CODES[code];
+    }
+    pos.whiteToMove = rec.flags & 1;
+    pos.canCastleK[1] = rec.flags & 2;
+    pos.canCastleQ[1] = rec.flags & 4;
+    pos.canCastleK[0] = rec.flags & 8;
+    pos.canCastleQ[0] = rec.flags & 16;
+    if (rec.enPassant == NO_SQUARE)
+        pos.enPassantTarget = {-1, -1};
+    else
+        pos.enPassantTarget = {rec.enPassant % BOARD_SIZE, rec.enPassant / BOARD_SIZE};
+}
+
+PackedWriter::PackedWriter(const std::string &path, size_t batchSize)
+    : file(fopen(path.c_str(), "wb")), batchSize(batchSize) {
+    if (!file)
+        std::cerr << "Failed to open " << path << " for writing\n";
+    buffer.reserve(batchSize);
+}
+
+PackedWriter::~PackedWriter() {
+    flush();
+    if (file)
+        fclose(file);
+}
+
+void PackedWriter::write(const PackedPosition &rec) {
+    buffer.push_back(rec);
+    if (buffer.size() >= batchSize)
+        flush();
+}
+
+void PackedWriter::flush() {
+    if (file && !buffer.empty() &&
+        fwrite(buffer.data(), sizeof(PackedPosition), buffer.size(), file) != buffer.size())
+        std::cerr << "Short write while flushing packed positions\n";
+    buffer.clear();
+}
+
+PackedReader::PackedReader(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << path << "\n";
+        return;
+    }
+    opened = true;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(PackedPosition))) {
+        mappedBytes = st.st_size - st.st_size % sizeof(PackedPosition);
+        void *p = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "Failed to map " << path << "\n";
+            mappedBytes = 0;
+            opened = false;
+        } else {
+            madvise(p, mappedBytes, MADV_SEQUENTIAL);
+            data = static_cast<const PackedPosition *>(p);
+            count = mappedBytes / sizeof(PackedPosition);
+        }
+    }
+    close(fd);
+}
+
+PackedReader::~PackedReader() {
+    if (data)
+        munmap(const_cast<PackedPosition *>(data), mappedBytes);
+}
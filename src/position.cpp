@@ -0,0 +1,525 @@
+#include "position.hpp"
+#include "attacks.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+void Position::reset() {
+    whiteToMove = true;
+    canCastleK[0] = canCastleK[1] = true;
+    canCastleQ[0] = canCastleQ[1] = true;
+    enPassantTarget = {-1, -1};
+
+    const char init[BOARD_SIZE][BOARD_SIZE] = {
+        {'r', 'n', 'b', 'q', 'k', 'b', 'n', 'r'},
+        {'p', 'p', 'p', 'p', 'p', 'p', 'p', 'p'},
+        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+        {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+        {'P', 'P', 'P', 'P', 'P', 'P', 'P', 'P'},
+        {'R', 'N', 'B', 'Q', 'K', 'B', 'N', 'R'}};
+
+    for (int y = 0; y < BOARD_SIZE; ++y)
+        for (int x = 0; x < BOARD_SIZE; ++x)
+            boardLogic[y][x] = init[y][x];
+}
+
+bool Position::setFen(const std::string &fen) {
+    size_t i = 0;
+    for (int y = 0; y < BOARD_SIZE; ++y) {
+        int x = 0;
+        for (; i < fen.size() && fen[i] != '/' && fen[i] != ' '; ++i) {
+            char c = fen[i];
+            if (isdigit(c)) {
+                for (int n = c - '0'; n > 0 && x < BOARD_SIZE; --n)
+                    boardLogic[y][x++] = ' ';
+            } else if (strchr("pnbrqkPNBRQK", c) && x < BOARD_SIZE) {
+                boardLogic[y][x++] = c;
+            } else {
+                return false;
+            }
+        }
+        if (x != BOARD_SIZE)
+            return false;
+        ++i;
+    }
+    if (i >= fen.size())
+        return false;
+    whiteToMove = fen[i] == 'w';
+
+    canCastleK[0] = canCastleK[1] = canCastleQ[0] = canCastleQ[1] = false;
+    for (i += 2; i < fen.size() && fen[i] != ' '; ++i) {
+        switch (fen[i]) {
+            case 'K': canCastleK[1] = true; break;
+            case 'Q': canCastleQ[1] = true; break;
+            case 'k': canCastleK[0] = true; break;
+            case 'q': canCastleQ[0] = true; break;
+        }
+    }
+
+    enPassantTarget = {-1, -1};
+    if (i + 2 < fen.size() && fen[i + 1] >= 'a' && fen[i + 1] <= 'h')
+        enPassantTarget = {fen[i + 1] - 'a', BOARD_SIZE - (fen[i + 2] - '0')};
+    return true;
+}
+
+namespace {
+
+// Compile-time description of one side
+template <bool White>
+struct Side {
+    static constexpr int forward = White ? -BOARD_SIZE : BOARD_SIZE;
+    static constexpr int pawnStartRow = White ? WHITE_PAWN_START_ROW : BLACK_PAWN_START_ROW;
+    static constexpr int backRow = (White ? WHITE_BACK_ROW : BLACK_BACK_ROW) * BOARD_SIZE;
+    static constexpr int castle = White ? 1 : 0;
+    static constexpr char pawn = White ? 'P' : 'p';
+    static constexpr char knight = White ? 'N' : 'n';
+    static constexpr char bishop = White ? 'B' : 'b';
+    static constexpr char rook = White ? 'R' : 'r';
+    static constexpr char queen = White ? 'Q' : 'q';
+    static constexpr char king = White ? 'K' : 'k';
+    static constexpr bool own(char p) { return White ? (p >= 'A' && p <= 'Z') : (p >= 'a' && p <= 'z'); }
+    static constexpr bool enemy(char p) { return White ? (p >= 'a' && p <= 'z') : (p >= 'A' && p <= 'Z'); }
+};
+
+template <bool White>
+inline void slide(const char *b, int sq, int firstDir, int lastDir, MoveList &out) {
+    for (int d = firstDir; d < lastDir; ++d) {
+        for (uint8_t t : RAYS.at[sq][d]) {
+            if (b[t] == ' ') {
+                out.add(sq, t);
+            } else {
+                if (Side<White>::enemy(b[t]))
+                    out.add(sq, t);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <bool White>
+void Position::generate(MoveList &out) const {
+    using S = Side<White>;
+    const char *b = &boardLogic[0][0];
+    int ep = inBounds(enPassantTarget.first, enPassantTarget.second)
+                 ? enPassantTarget.second * BOARD_SIZE + enPassantTarget.first : -1;
+
+    for (int sq = 0; sq < SQUARES; ++sq) {
+        char p = b[sq];
+        if (!S::own(p))
+            continue;
+
+        switch (p) {
+            case S::pawn: {
+                int fwd = sq + S::forward;
+                if (fwd < 0 || fwd >= SQUARES)
+                    break;
+                if (b[fwd] == ' ') {
+                    out.add(sq, fwd);
+                    if (sq / BOARD_SIZE == S::pawnStartRow && b[fwd + S::forward] == ' ')
+                        out.add(sq, fwd + S::forward);
+                }
+                for (uint8_t t : PAWN_ATTACKS[White].at[sq]) {
+                    if (S::enemy(b[t]))
+                        out.add(sq, t);
+                    else if (t == ep && b[t - S::forward] != ' ')
+                        out.add(sq, t);
+                }
+                break;
+            }
+            case S::knight:
+                for (uint8_t t : KNIGHT_ATTACKS.at[sq])
+                    if (!S::own(b[t]))
+                        out.add(sq, t);
+                break;
+            case S::bishop:
+                slide<White>(b, sq, FIRST_DIAGONAL, 8, out);
+                break;
+            case S::rook:
+                slide<White>(b, sq, 0, FIRST_DIAGONAL, out);
+                break;
+            case S::queen:
+                slide<White>(b, sq, 0, 8, out);
+                break;
+            case S::king:
+                for (uint8_t t : KING_ATTACKS.at[sq])
+                    if (!S::own(b[t]))
+                        out.add(sq, t);
+                if (canCastleK[S::castle] && b[S::backRow + 5] == ' ' && b[S::backRow + 6] == ' ')
+                    out.add(S::backRow + 4, S::backRow + 6);
+                if (canCastleQ[S::castle] && b[S::backRow + 3] == ' ' && b[S::backRow + 2] == ' ' &&
+                    b[S::backRow + 1] == ' ')
+                    out.add(S::backRow + 4, S::backRow + 2);
+                break;
+        }
+    }
+}
+
+void Position::generatePseudo(MoveList &out) const {
+    out.count = 0;
+    if (whiteToMove)
+        generate<true>(out);
+    else
+        generate<false>(out);
+}
+
+void Position::generateLegal(MoveList &out) {
+    generatePseudo(out);
+    int kept = 0;
+    for (int i = 0; i < out.count; ++i)
+        if (isLegal(out.moves[i]))
+            out.moves[kept++] = out.moves[i];
+    out.count = kept;
+}
+
+bool Position::isLegal(GenMove mv) {
+    int x1 = mv.x1(), y1 = mv.y1(), x2 = mv.x2(), y2 = mv.y2();
+    char pc = boardLogic[y1][x1], cap = boardLogic[y2][x2];
+    bool isKingMove = (tolower(pc) == 'k');
+    bool isCastling = (isKingMove && abs(x2 - x1) == 2);
+
+    if (isCastling) {
+        if (inCheck(whiteToMove))
+            return false;
+        int passX = (x1 + x2) / 2;
+        if (isSquareAttacked(passX, y1, !whiteToMove))
+            return false;
+        if (isSquareAttacked(x2, y2, !whiteToMove))
+            return false;
+    }
+
+    boardLogic[y2][x2] = pc;
+    boardLogic[y1][x1] = ' ';
+    bool ep = (tolower(pc) == 'p' && x2 != x1 && cap == ' ');
+    char epCap = ' ';
+    if (ep) {
+        epCap = boardLogic[y1][x2];
+        boardLogic[y1][x2] = ' ';
+    }
+
+    bool safe = !inCheck(whiteToMove);
+    boardLogic[y1][x1] = pc;
+    boardLogic[y2][x2] = cap;
+    if (ep)
+        boardLogic[y1][x2] = epCap;
+    return safe;
+}
+
+std::set<std::vector<int>> Position::pseudoLegalMoves(bool w) const {
+    MoveList list;
+    if (w)
+        generate<true>(list);
+    else
+        generate<false>(list);
+    std::set<std::vector<int>> M;
+    for (auto mv : list)
+        M.insert({mv.x1(), mv.y1(), mv.x2(), mv.y2()});
+    return M;
+}
+
+std::set<std::vector<int>> Position::legalMoves() {
+    MoveList list;
+    generateLegal(list);
+    std::set<std::vector<int>> L;
+    for (auto mv : list)
+        L.insert({mv.x1(), mv.y1(), mv.x2(), mv.y2()});
+    return L;
+}
+
+bool Position::inCheck(bool white) const {
+    const char *b = &boardLogic[0][0];
+    const void *k = memchr(b, white ? 'K' : 'k', SQUARES);
+    if (!k) return false;
+    int sq = static_cast<int>(static_cast<const char *>(k) - b);
+    return white ? attacked<false>(sq) : attacked<true>(sq);
+}
+
+// Looks outward from the square for each attacker type instead of
+// generating the opponent's moves.
+template <bool ByWhite>
+bool Position::attacked(int sq) const {
+    using S = Side<ByWhite>;
+    const char *b = &boardLogic[0][0];
+
+    // A pawn attacks sq from the squares an opposing pawn on sq would attack
+    for (uint8_t t : PAWN_ATTACKS[!ByWhite].at[sq])
+        if (b[t] == S::pawn)
+            return true;
+    for (uint8_t t : KNIGHT_ATTACKS.at[sq])
+        if (b[t] == S::knight)
+            return true;
+    for (uint8_t t : KING_ATTACKS.at[sq])
+        if (b[t] == S::king)
+            return true;
+
+    for (int d = 0; d < 8; ++d) {
+        char slider = d < FIRST_DIAGONAL ? S::rook : S::bishop;
+        for (uint8_t t : RAYS.at[sq][d]) {
+            if (b[t] == ' ')
+                continue;
+            if (b[t] == slider || b[t] == S::queen)
+                return true;
+            break;
+        }
+    }
+    return false;
+}
+
+bool Position::isSquareAttacked(int x, int y, bool byWhite) const {
+    int sq = y * BOARD_SIZE + x;
+    return byWhite ? attacked<true>(sq) : attacked<false>(sq);
+}
+
+namespace {
+
+// Exchange values: a bishop counts as a knight, so trading one for the other
+// nets 0 rather than the evaluation's 10 cp difference.
+inline int seeValue(char p) {
+    switch (tolower(p)) {
+        case 'k': return SEE_KING_VALUE;
+        case 'b': return pieceValue('n');
+        default:  return pieceValue(p);
+    }
+}
+
+// Cheapest piece of the given side attacking sq through the pieces still
+// in occ, or -1. Removed pieces uncover x-ray attackers behind them.
+int leastValuableAttacker(const char *b, uint64_t occ, int sq, bool white) {
+    auto has = [&](int t) { return (occ >> t) & 1; };
+    auto own = [&](int t, char lower) { return has(t) && b[t] == (white ? toupper(lower) : lower); };
+
+    for (uint8_t t : PAWN_ATTACKS[!white].at[sq])
+        if (own(t, 'p'))
+            return t;
+    for (uint8_t t : KNIGHT_ATTACKS.at[sq])
+        if (own(t, 'n'))
+            return t;
+
+    int best = -1, bestValue = SEE_KING_VALUE + 1;
+    for (int d = 0; d < 8; ++d) {
+        for (uint8_t t : RAYS.at[sq][d]) {
+            if (!has(t))
+                continue;
+            char c = tolower(b[t]);
+            bool slides = c == 'q' || c == (d < FIRST_DIAGONAL ? 'r' : 'b');
+            if (slides && own(t, c) && seeValue(c) < bestValue) {
+                best = t;
+                bestValue = seeValue(c);
+            }
+            break;
+        }
+    }
+    if (best >= 0)
+        return best;
+
+    for (uint8_t t : KING_ATTACKS.at[sq])
+        if (own(t, 'k'))
+            return t;
+    return -1;
+}
+
+} // namespace
+
+int Position::see(GenMove mv) const {
+    const char *b = &boardLogic[0][0];
+    uint64_t occ = 0;
+    for (int sq = 0; sq < SQUARES; ++sq)
+        if (b[sq] != ' ')
+            occ |= 1ULL << sq;
+
+    int from = mv.from, to = mv.to;
+    char moving = b[from];
+    bool pawn = tolower(moving) == 'p';
+    int gain[32];
+    gain[0] = seeValue(b[to]);
+    if (pawn && b[to] == ' ' && mv.x1() != mv.x2()) {
+        gain[0] = pieceValue('p');
+        occ &= ~(1ULL << (mv.y1() * BOARD_SIZE + mv.x2()));
+    }
+
+    // Value of the piece that just captured, which the other side may take next
+    int attackerValue = seeValue(moving);
+    if (pawn && (mv.y2() == WHITE_BACK_ROW || mv.y2() == BLACK_BACK_ROW)) {
+        gain[0] += pieceValue('q') - pieceValue('p');
+        attackerValue = pieceValue('q');
+    }
+
+    int d = 0, sq = from;
+    bool white = isWhite(moving);
+    do {
+        ++d;
+        // Speculative: assumes the other side recaptures. No early cutoff,
+        // which would only keep the sign, so callers get exact values.
+        gain[d] = attackerValue - gain[d - 1];
+        occ &= ~(1ULL << sq);
+        white = !white;
+        sq = leastValuableAttacker(b, occ, to, white);
+        if (sq >= 0)
+            attackerValue = seeValue(b[sq]);
+    } while (sq >= 0 && d < 31);
+
+    while (--d)
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    return gain[0];
+}
+
+Move Position::makeMove(int x1, int y1, int x2, int y2) {
+    char pc = boardLogic[y1][x1], tgt = boardLogic[y2][x2];
+    Move m;
+    m.oldCastleK[0] = canCastleK[0];
+    m.oldCastleK[1] = canCastleK[1];
+    m.oldCastleQ[0] = canCastleQ[0];
+    m.oldCastleQ[1] = canCastleQ[1];
+    m.oldEnPassant = enPassantTarget;
+
+    m.x1 = x1;
+    m.y1 = y1;
+    m.x2 = x2;
+    m.y2 = y2;
+    m.moved = pc;
+    m.captured = tgt;
+
+    m.wasEnPassant = (tolower(pc) == 'p' && x1 != x2 && tgt == ' ');
+    if (m.wasEnPassant) {
+        m.captured = boardLogic[y1][x2];
+        boardLogic[y1][x2] = ' ';
+    }
+
+    if (tolower(m.captured) == 'r') {
+        int ry = whiteToMove ? BLACK_BACK_ROW : WHITE_BACK_ROW;
+        int capY = m.wasEnPassant ? y1 : y2;
+        if (capY == ry) {
+            if (x2 == 0) {
+                canCastleQ[!whiteToMove] = false;
+            } else if (x2 == 7) {
+                canCastleK[!whiteToMove] = false;
+            }
+        }
+    }
+
+    if (tolower(pc) == 'k') {
+        canCastleK[whiteToMove] = canCastleQ[whiteToMove] = false;
+        if (abs(x2 - x1) == 2) {
+            m.wasCastling = true;
+            int ry = whiteToMove ? WHITE_BACK_ROW : BLACK_BACK_ROW;
+            if (x2 > x1) {
+                m.rookX1 = 7;
+                m.rookY1 = ry;
+                m.rookX2 = x2 - 1;
+                m.rookY2 = ry;
+            } else {
+                m.rookX1 = 0;
+                m.rookY1 = ry;
+                m.rookX2 = x2 + 1;
+                m.rookY2 = ry;
+            }
+            char r = boardLogic[m.rookY1][m.rookX1];
+            boardLogic[m.rookY1][m.rookX1] = ' ';
+            boardLogic[m.rookY2][m.rookX2] = r;
+        }
+    }
+
+    if (tolower(pc) == 'r') {
+        int ry = whiteToMove ? WHITE_BACK_ROW : BLACK_BACK_ROW;
+        if (y1 == ry) {
+            if (x1 == 0) canCastleQ[whiteToMove] = false;
+            if (x1 == 7) canCastleK[whiteToMove] = false;
+        }
+    }
+
+    boardLogic[y2][x2] = pc;
+    boardLogic[y1][x1] = ' ';
+
+    m.wasPromotion = false;
+    if (tolower(pc) == 'p' && (y2 == BLACK_BACK_ROW || y2 == WHITE_BACK_ROW)) {
+        m.wasPromotion = true;
+        boardLogic[y2][x2] = whiteToMove ? 'Q' : 'q';
+    }
+
+    int dir = isWhite(pc) ? -1 : +1;
+    if (tolower(pc) == 'p' && abs(y2 - y1) == 2) {
+        enPassantTarget = {x2, y1 + dir};
+    } else {
+        enPassantTarget = {-1, -1};
+    }
+
+    whiteToMove = !whiteToMove;
+    return m;
+}
+
+void Position::unmakeMove(const Move &m) {
+    whiteToMove = !whiteToMove;
+
+    if (m.wasEnPassant) {
+        boardLogic[m.y1][m.x1] = m.moved;
+        boardLogic[m.y2][m.x2] = ' ';
+        boardLogic[m.y1][m.x2] = m.captured;
+    } else {
+        boardLogic[m.y1][m.x1] = m.moved;
+        boardLogic[m.y2][m.x2] = m.captured;
+    }
+
+    if (m.wasCastling) {
+        char r = boardLogic[m.rookY2][m.rookX2];
+        boardLogic[m.rookY2][m.rookX2] = ' ';
+        boardLogic[m.rookY1][m.rookX1] = r;
+    }
+
+    if (m.wasPromotion) {
+        boardLogic[m.y1][m.x1] = (whiteToMove ? 'P' : 'p');
+    }
+
+    canCastleK[0] = m.oldCastleK[0];
+    canCastleK[1] = m.oldCastleK[1];
+    canCastleQ[0] = m.oldCastleQ[0];
+    canCastleQ[1] = m.oldCastleQ[1];
+    enPassantTarget = m.oldEnPassant;
+}
+
+std::string Position::toSan(int x1, int y1, int x2, int y2) {
+    auto square = [](int x, int y) {
+        return std::string{static_cast<char>('a' + x), static_cast<char>('0' + BOARD_SIZE - y)};
+    };
+    char pc = boardLogic[y1][x1];
+    char kind = tolower(pc);
+    bool capture = boardLogic[y2][x2] != ' ' || (kind == 'p' && x1 != x2);
+
+    std::string san;
+    if (kind == 'k' && std::abs(x2 - x1) == 2) {
+        san = x2 > x1 ? "O-O" : "O-O-O";
+    } else if (kind == 'p') {
+        if (capture)
+            san = std::string(1, static_cast<char>('a' + x1)) + "x";
+        san += square(x2, y2);
+        if (y2 == WHITE_BACK_ROW || y2 == BLACK_BACK_ROW)
+            san += "=Q";
+    } else {
+        san = std::string(1, static_cast<char>(toupper(pc)));
+        bool ambiguous = false, sameFile = false, sameRank = false;
+        for (auto &mv : legalMoves()) {
+            if (mv[2] != x2 || mv[3] != y2 || (mv[0] == x1 && mv[1] == y1) || boardLogic[mv[1]][mv[0]] != pc)
+                continue;
+            ambiguous = true;
+            sameFile |= mv[0] == x1;
+            sameRank |= mv[1] == y1;
+        }
+        if (ambiguous && !sameFile)
+            san += static_cast<char>('a' + x1);
+        else if (ambiguous && !sameRank)
+            san += static_cast<char>('0' + BOARD_SIZE - y1);
+        else if (ambiguous)
+            san += square(x1, y1);
+        if (capture)
+            san += "x";
+        san += square(x2, y2);
+    }
+
+    Move m = makeMove(x1, y1, x2, y2);
+    if (inCheck(whiteToMove))
+        san += legalMoves().empty() ? "#" : "+";
+    unmakeMove(m);
+    return san;
+}
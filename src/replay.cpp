@@ -0,0 +1,133 @@
+#include "replay.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+static const char *REPLAY_HEADER = "chess-replay 1";
+
+// One line per event: frame, type, then the type's fields
+bool InputRecorder::open(const std::string &path) {
+    out.open(path);
+    if (!out) {
+        std::cerr << "Failed to open " << path << " for recording\n";
+        return false;
+    }
+    out << REPLAY_HEADER << "\n";
+    return true;
+}
+
+void InputRecorder::record(long frame, const sf::Event &ev) {
+    switch (ev.type) {
+        case sf::Event::Closed:
+            out << frame << " " << ev.type << "\n";
+            break;
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+            out << frame << " " << ev.type << " " << ev.key.code << " " << ev.key.alt << " "
+                << ev.key.control << " " << ev.key.shift << " " << ev.key.system << "\n";
+            break;
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            out << frame << " " << ev.type << " " << ev.mouseButton.button << " "
+                << ev.mouseButton.x << " " << ev.mouseButton.y << "\n";
+            break;
+        case sf::Event::MouseMoved:
+            out << frame << " " << ev.type << " " << ev.mouseMove.x << " " << ev.mouseMove.y << "\n";
+            break;
+        default:
+            break;
+    }
+}
+
+bool InputReplay::load(const std::string &path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line) || line != REPLAY_HEADER) {
+        std::cerr << "Failed to read replay " << path << "\n";
+        return false;
+    }
+    events.clear();
+    next = 0;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        RecordedEvent r{};
+        int type = 0;
+        if (!(ls >> r.frame >> type))
+            continue;
+        r.event.type = static_cast<sf::Event::EventType>(type);
+        int a = 0, b = 0, c = 0, d = 0, e = 0;
+        switch (r.event.type) {
+            case sf::Event::KeyPressed:
+            case sf::Event::KeyReleased:
+                ls >> a >> b >> c >> d >> e;
+                r.event.key.code = static_cast<sf::Keyboard::Key>(a);
+                r.event.key.alt = b;
+                r.event.key.control = c;
+                r.event.key.shift = d;
+                r.event.key.system = e;
+                break;
+            case sf::Event::MouseButtonPressed:
+            case sf::Event::MouseButtonReleased:
+                ls >> a >> b >> c;
+                r.event.mouseButton.button = static_cast<sf::Mouse::Button>(a);
+                r.event.mouseButton.x = b;
+                r.event.mouseButton.y = c;
+                break;
+            case sf::Event::MouseMoved:
+                ls >> a >> b;
+                r.event.mouseMove.x = a;
+                r.event.mouseMove.y = b;
+                break;
+            default:
+                break;
+        }
+        events.push_back(r);
+    }
+    lastFrame = events.empty() ? -1 : events.back().frame;
+    return true;
+}
+
+void InputReplay::eventsForFrame(long frame, std::vector<sf::Event> &out) {
+    for (; next < events.size() && events[next].frame <= frame; ++next)
+        out.push_back(events[next].event);
+}
+
+void FrameStats::add(double ms, int inputEvents) {
+    frameMs.push_back(ms);
+    inputs.push_back(inputEvents);
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    size_t rank = static_cast<size_t>(p / 100.0 * (v.size() - 1) + 0.5);
+    return v[rank];
+}
+
+void FrameStats::report(std::ostream &os) const {
+    std::vector<double> latency;
+    for (size_t i = 0; i < frameMs.size(); ++i)
+        if (inputs[i] > 0)
+            latency.push_back(frameMs[i]);
+
+    auto line = [&](const char *label, const std::vector<double> &v) {
+        os << label << " n=" << v.size() << "  p50 " << percentile(v, 50) << " ms  p95 "
+           << percentile(v, 95) << " ms  p99 " << percentile(v, 99) << " ms  max "
+           << percentile(v, 100) << " ms\n";
+    };
+    line("frame time      ", frameMs);
+    line("input-to-present", latency);
+}
+
+bool FrameStats::writeCsv(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write " << path << "\n";
+        return false;
+    }
+    out << "frame,input_events,frame_ms\n";
+    for (size_t i = 0; i < frameMs.size(); ++i)
+        out << i << "," << inputs[i] << "," << frameMs[i] << "\n";
+    return true;
+}
@@ -0,0 +1,172 @@
+#include "search.hpp"
+#include <algorithm>
+#include <chrono>
+
+// Per-thread search deadline; searches without one never stop early.
+static thread_local bool hasDeadline = false;
+static thread_local bool stopped = false;
+static thread_local long long nodes = 0;
+static thread_local std::chrono::steady_clock::time_point deadline;
+static thread_local const std::atomic<bool> *cancelFlag = nullptr;
+
+static bool timeUp() {
+    if (!hasDeadline)
+        return false;
+    if ((++nodes & 1023) == 0 && (std::chrono::steady_clock::now() >= deadline ||
+                                  (cancelFlag && cancelFlag->load(std::memory_order_relaxed))))
+        stopped = true;
+    return stopped;
+}
+
+int evaluate(const Position &pos) {
+    int score = 0;
+    for (int y = 0; y < BOARD_SIZE; ++y) {
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            char p = pos.boardLogic[y][x];
+            if (p == ' ') continue;
+            int v = pieceValue(p);
+            // Small positional terms: pawns gain as they advance, minor
+            // pieces prefer the centre.
+            switch (tolower(p)) {
+                case 'p':
+                    v += 5 * (pos.isWhite(p) ? WHITE_PAWN_START_ROW - y : y - BLACK_PAWN_START_ROW);
+                    break;
+                case 'n':
+                case 'b':
+                    v += 10 - 3 * (std::abs(2 * x - 7) + std::abs(2 * y - 7)) / 2;
+                    break;
+            }
+            score += pos.isWhite(p) ? v : -v;
+        }
+    }
+    return pos.whiteToMove ? score : -score;
+}
+
+// Most valuable victim first, cheapest attacker as tie-break; quiet moves
+// keep generator order after the captures.
+static void orderMoves(const Position &pos, MoveList &list) {
+    int keys[MAX_MOVES];
+    for (int i = 0; i < list.size(); ++i) {
+        GenMove mv = list[i];
+        keys[i] = 0;
+        if (isCapture(pos, mv)) {
+            char victim = pos.boardLogic[mv.y2()][mv.x2()];
+            keys[i] = 10 * (victim == ' ' ? 100 : pieceValue(victim)) -
+                      pieceValue(pos.boardLogic[mv.y1()][mv.x1()]) / 10 + 10000;
+        }
+    }
+    for (int i = 1; i < list.size(); ++i) {
+        GenMove mv = list[i];
+        int key = keys[i], j = i;
+        for (; j > 0 && keys[j - 1] < key; --j) {
+            keys[j] = keys[j - 1];
+            list[j] = list[j - 1];
+        }
+        keys[j] = key;
+        list[j] = mv;
+    }
+}
+
+int quiesce(Position &pos, int alpha, int beta) {
+    if (timeUp())
+        return 0;
+    int standPat = evaluate(pos);
+    if (standPat >= beta)
+        return standPat;
+    alpha = std::max(alpha, standPat);
+
+    // Legality is only checked for the captures that survive the filter
+    MoveList list;
+    pos.generatePseudo(list);
+    int kept = 0;
+    // Captures that lose material cannot raise alpha above stand pat
+    for (auto mv : list)
+        if (isCapture(pos, mv) && pos.see(mv) >= 0)
+            list.moves[kept++] = mv;
+    list.count = kept;
+    orderMoves(pos, list);
+
+    for (auto mv : list) {
+        if (!pos.isLegal(mv))
+            continue;
+        Move m = pos.makeMove(mv);
+        int score = -quiesce(pos, -beta, -alpha);
+        pos.unmakeMove(m);
+        if (score >= beta)
+            return score;
+        alpha = std::max(alpha, score);
+    }
+    return alpha;
+}
+
+int alphaBeta(Position &pos, int depth, int alpha, int beta, int ply) {
+    if (depth <= 0)
+        return quiesce(pos, alpha, beta);
+    if (timeUp())
+        return 0;
+
+    MoveList list;
+    pos.generateLegal(list);
+    if (list.empty())
+        return pos.inCheck(pos.whiteToMove) ? -MATE_SCORE + ply : 0;
+    orderMoves(pos, list);
+
+    int best = -INF_SCORE;
+    for (auto mv : list) {
+        Move m = pos.makeMove(mv);
+        int score = -alphaBeta(pos, depth - 1, -beta, -alpha, ply + 1);
+        pos.unmakeMove(m);
+        if (score > best) {
+            best = score;
+            alpha = std::max(alpha, score);
+            if (alpha >= beta)
+                break;
+        }
+    }
+    return best;
+}
+
+int searchRoot(Position &pos, int depth, std::vector<int> &best) {
+    best.clear();
+    MoveList list;
+    pos.generateLegal(list);
+    if (list.empty())
+        return pos.inCheck(pos.whiteToMove) ? -MATE_SCORE : 0;
+    orderMoves(pos, list);
+
+    int alpha = -INF_SCORE;
+    for (auto mv : list) {
+        Move m = pos.makeMove(mv);
+        int score = -alphaBeta(pos, depth - 1, -INF_SCORE, -alpha, 1);
+        pos.unmakeMove(m);
+        if (score > alpha || best.empty()) {
+            alpha = score;
+            best = {mv.x1(), mv.y1(), mv.x2(), mv.y2()};
+        }
+    }
+    return alpha;
+}
+
+int searchTimed(Position &pos, int budgetMs, std::vector<int> &best, int maxDepth,
+                const std::atomic<bool> *cancel) {
+    hasDeadline = true;
+    stopped = false;
+    cancelFlag = cancel;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(budgetMs);
+
+    // Depth 1 always completes so there is a move and score to report.
+    std::vector<int> iterBest;
+    hasDeadline = false;
+    int score = searchRoot(pos, 1, best);
+    hasDeadline = true;
+    for (int depth = 2; depth <= maxDepth && std::abs(score) < MATE_SCORE - 100; ++depth) {
+        int s = searchRoot(pos, depth, iterBest);
+        if (stopped)
+            break;
+        score = s;
+        best = iterBest;
+    }
+    hasDeadline = stopped = false;
+    cancelFlag = nullptr;
+    return score;
+}
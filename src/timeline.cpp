@@ -0,0 +1,79 @@
+#include "timeline.hpp"
+#include <algorithm>
+
+void Timeline::reset(const Position &start) {
+    moves.clear();
+    checkpoints.assign(1, start);
+    checkpointInterval = CHECKPOINT_INTERVAL;
+    currentPly = 0;
+}
+
+void Timeline::play(Position &pos, int x1, int y1, int x2, int y2) {
+    truncate(currentPly);
+    moves.push_back(pos.makeMove(x1, y1, x2, y2));
+    ++currentPly;
+    recordCheckpoint(pos);
+}
+
+bool Timeline::undo(Position &pos) {
+    int before = size();
+    truncate(currentPly);
+    if (currentPly == 0)
+        return size() != before;
+
+    pos.unmakeMove(moves.back());
+    moves.pop_back();
+    --currentPly;
+    // The snapshot at this ply, if any, belongs to the line just taken back
+    checkpoints.resize(currentPly / checkpointInterval + 1);
+    return true;
+}
+
+void Timeline::jumpTo(Position &pos, int ply) {
+    ply = std::clamp(ply, 0, size());
+    if (ply == currentPly)
+        return;
+
+    if (ply == currentPly - 1) {
+        pos.unmakeMove(moves[ply]);
+    } else {
+        int base = ply / checkpointInterval;
+        int from = base * checkpointInterval;
+        if (ply < currentPly || currentPly < from)
+            pos = checkpoints[base];
+        else
+            from = currentPly;
+        for (int i = from; i < ply; ++i) {
+            const Move &m = moves[i];
+            pos.makeMove(m.x1, m.y1, m.x2, m.y2);
+        }
+    }
+    currentPly = ply;
+}
+
+void Timeline::recordCheckpoint(const Position &pos) {
+    if (currentPly % checkpointInterval != 0)
+        return;
+    size_t slot = currentPly / checkpointInterval;
+    if (slot < checkpoints.size()) {
+        checkpoints[slot] = pos;
+        return;
+    }
+    checkpoints.push_back(pos);
+
+    // Keep memory bounded on very long games: drop every other snapshot
+    // and double the spacing, so a jump never replays more than the interval.
+    if (checkpoints.size() > MAX_CHECKPOINTS) {
+        for (size_t i = 0; 2 * i < checkpoints.size(); ++i)
+            checkpoints[i] = checkpoints[2 * i];
+        checkpoints.resize((checkpoints.size() + 1) / 2);
+        checkpointInterval *= 2;
+    }
+}
+
+void Timeline::truncate(int ply) {
+    if (ply >= size())
+        return;
+    moves.resize(ply);
+    checkpoints.resize(ply / checkpointInterval + 1);
+}